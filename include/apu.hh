@@ -2,19 +2,56 @@
 #define APU_HH
 
 #include "ars-emu.hh"
+#include "et209.hh"
 
-class ET209;
+#include <vector>
 
 namespace ARS {
-  extern ET209 apu;
+  /* Everything one APU remembers. Each Machine has its own; write_apu,
+     run_apu, and the hashing functions work on the one belonging to the
+     current thread's machine (see machine.hh). */
+  struct APUState {
+    ET209 chip;
+    // APU writes made during the current CPU::runCycles, in order
+    struct PendingWrite {
+      int cycle;
+      uint8_t addr, value;
+    };
+    std::vector<PendingWrite> pending_writes;
+    // FNV-1a of every sample synthesized, if enabled; see set_audio_hashing
+    bool hashing = false;
+    uint64_t hash = 0xcbf29ce484222325;
+  };
+  extern __thread APUState* apu_state;
   enum class FloppySoundType {
     SHORT_SEEK=0,
     LONG_SEEK_1,
     LONG_SEEK_2,
     NUM_FLOPPY_SOUNDS,
   };
-  void init_apu(); // may be called more than once
-  void output_apu_sample();
+  // may be called more than once; the audio device plays the current
+  // thread's machine, which must be the primary one
+  void init_apu();
+  // Called by the CPU at the end of each runCycles, with the same cycle count
+  // it was given. Synthesizes every sample that came due during those cycles,
+  // applying the APU writes made during them on the samples they belong to.
+  // audio_cycle_counter is the CPU's count of cycles since the last sample.
+  void run_apu(uint32_t& audio_cycle_counter, int count);
+  // Records an APU register write, timestamped with CPU::cyclesIntoRun, to be
+  // applied by the next run_apu.
+  void write_apu(uint8_t addr, uint8_t value);
+  // Only every Nth sample will be queued for output (the APU still runs for
+  // every sample). Used to keep fast-forward from overrunning the queue.
+  void set_audio_decimation(unsigned int n);
+  // Hash every sample the APU synthesizes (before any conversion), even if
+  // there's no audio device (or the machine isn't the one it plays). Used by
+  // headless mode; the result depends only on what the emulated program did,
+  // not on any audio settings.
+  void set_audio_hashing(bool enabled);
+  uint64_t get_audio_hash();
+  // summarizes the audio telemetry (underruns, overruns, latency) in a UI
+  // message, and dumps it in full, with histograms, to stdout
+  void show_audio_stats();
   // once set up, will remain set up across init_apu calls
   void setup_floppy_sounds();
   // drive is 0 or 1, delay_till_next is in frames and must not be zero.
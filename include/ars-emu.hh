@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <sstream>
 #include <memory>
+#include <random>
 #include "SDL.h"
 #include "sn.hh"
 
@@ -14,6 +15,9 @@ extern SN::Context sn;
 
 namespace ARS {
   class Display;
+  class CPU;
+  class Cartridge;
+  class Expansion;
   extern std::unique_ptr<Display> display;
   static constexpr int HARD_BLANK_CYCLES_PER_SCANLINE = 134;
   static constexpr int SAFE_BLANK_CYCLES_PER_SCANLINE = 74;
@@ -40,9 +44,41 @@ namespace ARS {
                 "wrong implied core clock");
   extern bool safe_mode, debugging_audio, debugging_video;
   extern std::string window_title;
-  extern uint16_t last_known_pc;
-  // $0000-7FFF
-  extern uint8_t dram[0x8000];
+  /* One entry per 256 bytes of CPU address space. A non-null entry points to
+     host memory that the whole page can be read from (or written to)
+     directly, with no side effects. Pages with registers in them, and pages
+     whose memory needs to see writes (e.g. to mark itself dirty), are null
+     and go through slowRead/slowWrite. Pages this small keep the registers
+     from taking zero page and the stack down with them. Rebuilt by
+     rebuildPageTables() whenever the bank map changes. */
+  static constexpr unsigned int BUS_PAGE_SHIFT = 8;
+  static constexpr uint16_t BUS_PAGE_MASK = (1 << BUS_PAGE_SHIFT) - 1;
+  /* Everything on the main board, and everything plugged into it. Each
+     Machine (see machine.hh) has one; the bus, and everything that talks to
+     it, works on the one belonging to the current thread's machine. */
+  struct MainBoard {
+    // $0000-7FFF
+    uint8_t dram[0x8000];
+    const uint8_t* read_pages[0x10000 >> BUS_PAGE_SHIFT] = {};
+    uint8_t* write_pages[0x10000 >> BUS_PAGE_SHIFT] = {};
+    uint8_t bankMap[8] = {};
+    uint16_t last_known_pc = 0;
+    bool secure_config_port_checked = false;
+    // where all power-on garbage comes from (see Machine::powerOn), so that
+    // machines seeded alike power on alike, on any host
+    std::minstd_rand garbage_source;
+    std::unique_ptr<CPU> cpu;
+    std::unique_ptr<Cartridge> cartridge;
+    // first two entries read from controller ports 1 and 2
+    std::unique_ptr<Expansion> expansions[8];
+    // true for the machine the frontend belongs to, whose frames go to the
+    // display and whose sound goes to the speakers
+    bool primary = false;
+    // defined in machine.cc, where CPU and friends are complete
+    MainBoard();
+    ~MainBoard();
+  };
+  extern __thread MainBoard* board;
   struct Regs {
     // ars-emu.cc makes some assumptions about the layout, check there if you
     // change anything
@@ -77,8 +113,11 @@ namespace ARS {
     // $0228-$022F are complex on write
     uint8_t bankMap[8];
   };
-  static inline Regs& Regs() { return *reinterpret_cast<struct Regs*>(dram+0x0200); }
-  extern class MessageImp {
+  static inline Regs& Regs() {
+    return *reinterpret_cast<struct Regs*>(board->dram+0x0200);
+  }
+  // each thread builds its own messages, and can finish them whenever
+  class MessageImp {
     std::ostringstream stream;
     void outputLine(std::string line, int lifespan_value);
     void outputBuffer();
@@ -91,24 +130,40 @@ namespace ARS {
       outputBuffer();
       return *this;
     }
-  } ui;
+  };
+  extern thread_local MessageImp ui;
   void triggerReset() __attribute__((noreturn));
   void triggerQuit() __attribute__((noreturn));
   /* Whenever an outside event causes a time discontinuity, it should call
      this function to avoid bad interactions with the frameskipping logic. */
   void temporalAnomaly();
-  uint8_t read(uint16_t addr, bool OL = false, bool VPB = false,
-               bool SYNC = false);
+  void rebuildPageTables();
+  uint8_t slowRead(uint16_t addr, bool OL, bool VPB, bool SYNC);
+  void slowWrite(uint16_t addr, uint8_t value);
+  inline uint8_t read(uint16_t addr, bool OL = false, bool VPB = false,
+                      bool SYNC = false) {
+    auto page = board->read_pages[addr >> BUS_PAGE_SHIFT];
+    // overlay and vector reads may be remapped by the cartridge
+    if(page && !OL && !VPB) {
+      if(SYNC) board->last_known_pc = addr;
+      return page[addr & BUS_PAGE_MASK];
+    }
+    return slowRead(addr, OL, VPB, SYNC);
+  }
   inline uint16_t read16(uint16_t addr) { return read(addr)|(read(addr+1)<<8);}
-  void write(uint16_t addr, uint8_t value);
+  inline void write(uint16_t addr, uint8_t value) {
+    auto page = board->write_pages[addr >> BUS_PAGE_SHIFT];
+    if(page) page[addr & BUS_PAGE_MASK] = value;
+    else slowWrite(addr, value);
+  }
   inline void write16(uint16_t addr, uint16_t value) {
     write(addr, value);
     write(addr+1, value>>8);
   }
   uint8_t getBankForAddr(uint16_t addr);
-  static_assert(RAND_MAX >= 4095, "not enough rand() bits for garbage");
+  // from the current machine's garbage_source
   static inline uint8_t garbage() {
-    return rand()>>4;
+    return board->garbage_source()>>4;
   }
   static inline void fillWithGarbage(void* _target, size_t count) {
     uint8_t* p = reinterpret_cast<uint8_t*>(_target);
@@ -0,0 +1,29 @@
+#ifndef AUDIO_CAPTURE_HH
+#define AUDIO_CAPTURE_HH
+
+#include "ars-emu.hh"
+
+namespace ARS {
+  /* Streams everything the APU generates to a raw file, from before any
+     filtering or mixing: five signed 16-bit little-endian samples per frame,
+     at the ET209's own rate. The first four are the ET209's Center, Right,
+     Left, and Boost outputs, the fifth is the floppy drive sounds. All five
+     are at 64 times the ET209's native scale, which is about -6dBFS at its
+     loudest. */
+  namespace AudioCapture {
+    // complains and returns false if the file couldn't be opened
+    bool start(const std::string& path);
+    // waits for everything captured so far to be written, then closes the
+    // file
+    void stop();
+    bool isActive();
+    // Called by whichever thread is running the APU; never blocks. Frames
+    // that don't fit in the ring (because the writer thread has fallen far
+    // behind) are dropped, and counted. et209_frames has four samples per
+    // frame, as ET209::output_block produces them.
+    void push(const int16_t* et209_frames, const float* floppy_frames,
+              size_t count);
+  }
+}
+
+#endif
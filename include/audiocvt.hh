@@ -63,10 +63,20 @@ public:
 };
 
 // supported channel counts: 1 2 3 4
+// quality_hint < 0: nearest neighbor
+// quality_hint = 0: nearest neighbor if dest_rate is within 1% of the ET209's
+//   rate, 32-tap windowed sinc otherwise
+// quality_hint = 1: 32-tap windowed sinc
+// quality_hint >= 2: 64-tap windowed sinc
 std::unique_ptr<AudioCvt> MakeAudioCvt(int quality_hint,
                                        float source_rate,
                                        float dest_rate,
                                        int number_of_input_samples,
                                        int number_of_channels);
+// Builds the filters that MakeAudioCvt needs for every source rate from
+// min_source_rate to max_source_rate, so that making a converter from the
+// audio callback doesn't have to. Call it before the audio device starts.
+void PrepareAudioCvt(int quality_hint, float min_source_rate,
+                     float max_source_rate, float dest_rate);
 
 #endif
@@ -26,12 +26,19 @@ namespace ARS {
     virtual void handleReset() { return; }
     virtual uint8_t getPowerOnBank() { return 0; }
     virtual uint8_t getBS() { return 0; }
+    /* Host pointer to the bus page that (non-overlay, non-vector) reads
+       from this bank and address come from, or nullptr if those reads need
+       to go through read(). The pointer must stay valid until the bank map
+       next changes. */
+    virtual const uint8_t* getReadPage(uint8_t, uint16_t) { return nullptr; }
+    // save the contents of any writable memories, and any mapper state
+    virtual void freeze(Freezer&) {}
+    virtual void defrost(Defroster&) {}
     static std::unique_ptr<Cartridge> load(GameFolder& gamefolder,
                                            Controller::Type& port1,
                                            Controller::Type& port2,
                                            std::string language_override = "");
   };
-  extern std::unique_ptr<Cartridge> cartridge;
   extern const std::unordered_map<std::string, std::function<std::unique_ptr<Cartridge>(byuuML::cursor mapper_tag, std::unordered_map<std::string, std::unique_ptr<Memory> >)> > mapper_types;
 }
 
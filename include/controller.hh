@@ -12,6 +12,11 @@ namespace ARS {
     EMUBUTTON_TOGGLE_SP,
     EMUBUTTON_TOGGLE_OL,
     EMUBUTTON_SCREENSHOT,
+    EMUBUTTON_FREEZE,
+    EMUBUTTON_DEFROST,
+    EMUBUTTON_REWIND,
+    EMUBUTTON_FAST_FORWARD,
+    EMUBUTTON_AUDIO_STATS,
     NUM_EMULATOR_BUTTONS
   };
   void handleEmulatorButtonPress(EmulatorButton button);
@@ -29,6 +34,8 @@ namespace ARS {
     virtual ~Controller() {}
     virtual void output(uint8_t d);
     virtual uint8_t input();
+    void freeze(Freezer&) override;
+    void defrost(Defroster&) override;
     static void initControllers(Type port1, Type port2);
     /* returns true if the event was fully handled, false if the event needs
        further handling (it may have been modified in the mean time) */
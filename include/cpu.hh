@@ -2,6 +2,7 @@
 #define CPUHH
 
 #include "ars-emu.hh"
+#include "savestate.hh"
 
 namespace ARS {
   class CPU {
@@ -12,17 +13,21 @@ namespace ARS {
     virtual void handleReset() = 0;
     virtual void eatCycles(int count) = 0;
     virtual void runCycles(int count) = 0;
+    // number of cycles that have passed since the current runCycles began
+    virtual int cyclesIntoRun() = 0;
     virtual void setIRQ(bool irq) = 0;
     virtual void setSO(bool so) = 0;
     virtual void setNMI(bool nmi) = 0;
     virtual bool isStopped() = 0;
     virtual void frameBoundary() {}
+    virtual void freeze(Freezer&) = 0;
+    virtual void defrost(Defroster&) = 0;
     // don't forget, NMI active = masked IRQ
   };
-  extern std::unique_ptr<CPU> cpu;
   std::unique_ptr<CPU> makeScanlineCPU(const std::string& rom_path);
   std::unique_ptr<CPU> makeScanlineIntProfCPU(const std::string& rom_path);
   std::unique_ptr<CPU> makeScanlineDebugCPU(const std::string& rom_path);
+  std::unique_ptr<CPU> makeCachedCPU(const std::string& rom_path);
 }
 
 #endif
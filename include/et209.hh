@@ -48,6 +48,7 @@
 #ifndef ET209_HH
 #define ET209_HH
 
+#include <stddef.h>
 #include <stdint.h>
 
 class ET209 {
@@ -208,11 +209,27 @@ public:
     out_samples[3] += noise;
     ++sample_number;
   }
+  /* Equivalent to calling output_frame `count` times, with the frames packed
+     one after the other into `out` (which must have room for 4*count
+     samples). Register writes must be applied between blocks, at the sample
+     they were made on, to get the same output as calling output_frame. */
+  void output_block(int16_t* out, size_t count) {
+    while(count-- > 0) {
+      output_frame(out);
+      out += 4;
+    }
+  }
   void write(int addr, uint8_t value) {
     addr &= 0x1F;
     if(addr == ADDR_NOISE_PERIOD) noise_accumulator = 0;
     ram[addr] = value;
   }
+  /* Passes the complete chip state through `ar`, which is called with an
+     lvalue for each field. Useful for emulator save states. */
+  template<class Archive> void transfer_state(Archive& ar) {
+    ar(ram); ar(real_rate); ar(voice_accumulator); ar(lfsr);
+    ar(noise_accumulator); ar(sample_number);
+  }
   /* Helper functions that are less useful to an emulator and more useful to a
      music authoring program */
   void write_voice_rate(int voice, uint16_t value) {
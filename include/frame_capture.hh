@@ -0,0 +1,40 @@
+#ifndef FRAME_CAPTURE_HH
+#define FRAME_CAPTURE_HH
+
+#include "ppu.hh"
+
+namespace ARS {
+  /* Streams every emulated frame to a file, as raw PPU color indices, for
+     turning into video later. The emulation thread only copies each frame
+     into a pooled buffer; compression and writing happen on another thread.
+
+     The file starts with "ARSVIDEO", a version byte, the width and height
+     (16-bit little-endian), and a 256-entry palette (8-bit R, G, B) that maps
+     the indices to colors. Each frame follows as a one-byte type, and for
+     the types that have one, a 32-bit little-endian length and that much
+     payload:
+     'K': a key frame; the payload is the whole frame, PackBits compressed
+     'D': the payload is the frame XORed with the previous frame, PackBits
+     compressed
+     'R': no payload; the previous frame, again
+     Key frames come once every ten seconds or so, to help seeking. */
+  namespace FrameCapture {
+    // complains and returns false if the file couldn't be opened
+    bool start(const std::string& path);
+    // waits for everything captured so far to be written, then closes the
+    // file
+    void stop();
+    bool isActive();
+    // Emulation thread only. Copies the frame and returns; if the writer
+    // thread has fallen so far behind that there's nowhere to copy it to, the
+    // frame is dropped, and the previous one will be repeated in its place.
+    // With wait, it waits for room instead (for headless runs, which have no
+    // real time to keep up with).
+    void push(const PPU::raw_screen& frame, bool wait = false);
+    // Emulation thread only. A frame was emulated but not rendered; the
+    // previous one will be repeated in its place.
+    void skip();
+  }
+}
+
+#endif
@@ -9,6 +9,19 @@ namespace FX {
   // thread_count = N -> use N threads
   // multithreading will only be used if initiated in the main core
   void init(unsigned int thread_count = 0);
+  // the number of threads init settled on (1 before init is called)
+  unsigned int getThreadCount();
+  // makes the calling thread the one whose FX calls are multithreaded (at
+  // first, the one that called init); only one thread can be at a time
+  void adoptCurrentThread();
+  // Picture controls for composite and S-Video. hue is in degrees, and turns
+  // every color around the color wheel. saturation multiplies the strength
+  // of the color. sharpness is 0 normally, up to 1 to sharpen the picture,
+  // down to -1 to soften it. Must not be called while FX calls are running.
+  struct TVControls {
+    float hue = 0, saturation = 1, sharpness = 0;
+  };
+  void setTVControls(const TVControls& controls);
   // lefts, rights, and widths must be multiples of 8
   // output_skips_rows should be true if you plan to scanline-filter the result
   void raw_screen_to_bgra(const ARS::PPU::raw_screen& in,
@@ -31,11 +44,32 @@ namespace FX {
   void svideo_bgra(const void* in, void* out,
                    unsigned int width, unsigned int height,
                    bool output_skips_rows);
+  // the same as raw_screen_to_bgra followed by composite_bgra or
+  // svideo_bgra (given an even top), but in one pass, with no intermediate
+  // buffer; taps that fall off the right edge see black
+  void composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                            unsigned int left, unsigned int top,
+                            unsigned int right, unsigned int bottom,
+                            bool output_skips_rows);
+  void svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                         unsigned int left, unsigned int top,
+                         unsigned int right, unsigned int bottom,
+                         bool output_skips_rows);
   // assumes the input skipped rows
   void scanline_crisp_bgra(void* buf,
                            unsigned int width, unsigned int height);
   void scanline_bright_bgra(void* buf,
                             unsigned int width, unsigned int height);
+  enum class Filter { RGB_2X, SVIDEO, COMPOSITE };
+  // raw_screen_to_bgra_2x, svideo_raw_screen, or composite_raw_screen,
+  // followed by scanline_crisp_bgra or (if bright) scanline_bright_bgra,
+  // done a few rows at a time while they're still in cache. Each pixel of
+  // out is written once, and never read, so it can be a locked texture. The
+  // last scanline is made from the row below the region, if there is one.
+  void filter_with_scanlines(const ARS::PPU::raw_screen& in, void* out,
+                             unsigned int left, unsigned int top,
+                             unsigned int right, unsigned int bottom,
+                             Filter filter, bool bright);
 }
 
 #endif
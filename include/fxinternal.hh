@@ -33,16 +33,97 @@ namespace FX {
       }
     }
     uint8_t operator[](uint16_t in) const { return delinearized[in]; }
+    // for gathers
+    const uint8_t* data() const { return delinearized; }
   };
   const Delinearize& delinearizer();
-  // TODO: generate filters at runtime, allowing configurable HSB, and maybe
-  // even alternative upscaling factors!
   constexpr int NUM_CHROMA_PHASES = 12;
+  // output pixels per input pixel; the kernels and the Upscaler only do 2
   constexpr int NUM_TV_SUBPIXELS = 2;
   constexpr int COMPOSITE_FILTER_RADIUS = 6;
   constexpr int SVIDEO_FILTER_RADIUS = 4;
-  extern const int32_t COMPOSITE_FIR[NUM_CHROMA_PHASES][NUM_TV_SUBPIXELS][(COMPOSITE_FILTER_RADIUS*2+1)*9];
-  extern const int32_t SVIDEO_FIR[NUM_CHROMA_PHASES][NUM_TV_SUBPIXELS][(SVIDEO_FILTER_RADIUS*2+1)*9];
+  /* The composite or S-Video FIR for the current TV controls, generated by
+     simulating an NTSC signal (see fxfir.cc), or loaded from the cache in
+     the config directory if it was generated with the same controls
+     before. Each tap is a 16.16 fixed-point matrix taking an input pixel's
+     red, green, and blue to a subpixel's:
+
+     int32_t fir[NUM_CHROMA_PHASES][NUM_TV_SUBPIXELS][num_taps][3 (in)][3]
+
+     Only built or thrown out on the thread that makes FX calls, and never
+     during one, so implementations can use it from any thread. */
+  class TVFIR {
+    TVFIR(const TVFIR&) = delete;
+    std::vector<int32_t> table;
+  public:
+    const int radius, num_taps;
+    TVFIR(bool composite, const TVControls& controls);
+    const int32_t* get(unsigned int phase, unsigned int subpixel) const {
+      return table.data() + (phase * NUM_TV_SUBPIXELS + subpixel)
+        * num_taps * 9;
+    }
+  };
+  const TVFIR& compositeFIR();
+  const TVFIR& svideoFIR();
+  /* One of the FIRs above, with every tap already applied to every color in
+     the hardware palette. Filtering straight from palette indices then costs
+     one lookup and three adds per tap, instead of nine multiply-adds on a
+     pixel that had to be expanded to BGRA first.
+
+     The palette only has a few dozen distinct colors, so indices are first
+     mapped to "slots", one per distinct color, to keep the table small. Slot
+     0 is a color that contributes nothing, for taps that fall outside the
+     picture.
+
+     Contributions are in BGRA order, and the ones for both subpixels are
+     side by side, so that a SIMD implementation can fetch a whole tap with
+     one load and pack the sums straight into pixels. */
+  class IndexedFIR {
+    IndexedFIR(const IndexedFIR&) = delete;
+  public:
+    struct Contribution { int32_t blue, green, red, unused; };
+    const int radius, num_taps;
+    uint8_t slots[256];
+    unsigned int num_slots;
+  private:
+    std::vector<Contribution> table;
+  public:
+    explicit IndexedFIR(const TVFIR& fir);
+    // tap N's contributions for slot S start at [(N*num_slots+S)*2], one per
+    // subpixel
+    const Contribution* get(unsigned int phase) const {
+      return table.data() + phase * num_taps * num_slots * NUM_TV_SUBPIXELS;
+    }
+  };
+  const IndexedFIR& compositeIndexedFIR();
+  const IndexedFIR& svideoIndexedFIR();
+  /* One of the FIRs above, rearranged for SIMD implementations that filter
+     BGRA pixels with 16-bit multiply-adds (pmaddwd), which is the only
+     multiply SSE2 has that keeps enough of the product.
+
+     Input channels are taken in pairs, blue with green and red with alpha,
+     and each pair is multiplied by a pair of coefficients and summed, once
+     for each of the output's blue, green, red, and alpha. The coefficients
+     don't fit in 16 bits, so each is split into c>>8 and c&255; the first
+     sums are shifted left by 8 and added to the second. Every group of
+     eight coefficients is repeated for each subpixel, so a tap looks like
+     this, with a group at each [part][pair][subpixel]:
+
+     int16_t tap[2 (c>>8, c&255)][2 (blue/green, red/alpha)][2][8] */
+  class VectorFIR {
+    VectorFIR(const VectorFIR&) = delete;
+    std::vector<int16_t> table;
+  public:
+    static constexpr int TAP_SIZE = 2 * 2 * NUM_TV_SUBPIXELS * 8;
+    const int radius, num_taps;
+    explicit VectorFIR(const TVFIR& fir);
+    // tap N starts at [N*TAP_SIZE]
+    const int16_t* get(unsigned int phase) const {
+      return table.data() + phase * num_taps * TAP_SIZE;
+    }
+  };
+  const VectorFIR& compositeVectorFIR();
+  const VectorFIR& svideoVectorFIR();
   constexpr uint32_t pack_pixel(int32_t red, int32_t green, int32_t blue) {
     if(red > 16777215) red = 255;
     else if(red < 0) red = 0;
@@ -67,6 +148,8 @@ namespace FX {
                                   unsigned int width, unsigned int height,
                                   bool output_skips_rows);
     typedef composite_bgra svideo_bgra;
+    typedef raw_screen_to_bgra composite_raw_screen;
+    typedef raw_screen_to_bgra svideo_raw_screen;
     typedef void(*scanline_crisp_bgra)(void* _buf,
                                        unsigned int width,
                                        unsigned int height);
@@ -103,16 +186,22 @@ namespace FX {
     };
     template<class T> struct lementation {
     public:
-      lementation(T candidate, imps<T>& imps) { imps.add(candidate); }
+      lementation(T candidate, imps<T>& imps, bool usable = true) {
+        if(usable) imps.add(candidate);
+      }
     };
 #define DEEPER_LEMENTATION_NAME(y) _lementation_##y
 #define LEMENTATION_NAME(y) DEEPER_LEMENTATION_NAME(y)
 #define IMPLEMENT(target) namespace { FX::Imp::lementation<FX::Proto::target> LEMENTATION_NAME(__LINE__)(target, FX::Imp::target()); }
+    // for implementations that need CPU features that might not be present
+#define IMPLEMENT_IF(target, usable) namespace { FX::Imp::lementation<FX::Proto::target> LEMENTATION_NAME(__LINE__)(target, FX::Imp::target(), usable); }
 #define MAKE_IMPS(x) imps<Proto::x>& x()
     MAKE_IMPS(raw_screen_to_bgra);
     MAKE_IMPS(raw_screen_to_bgra_2x);
     MAKE_IMPS(composite_bgra);
     MAKE_IMPS(svideo_bgra);
+    MAKE_IMPS(composite_raw_screen);
+    MAKE_IMPS(svideo_raw_screen);
     MAKE_IMPS(scanline_crisp_bgra);
     MAKE_IMPS(scanline_bright_bgra);
 #undef MAKE_IMPS
@@ -12,6 +12,13 @@ namespace ARS {
       : Memory(data.release(), size) {}
     ~LoadedROMContent() { delete[] memory_buffer; }
   };
+#ifdef MMAP_AVAILABLE
+  /* Maps the first `size` bytes of an open file, read-only, as ROM. Returns
+     nullptr if the file is shorter than that (and so would need padding),
+     isn't a regular file, or can't be mapped. Doesn't close fd; the mapping
+     keeps its own reference to the file. */
+  std::unique_ptr<Memory> mapROMContent(int fd, size_t size);
+#endif
   std::unique_ptr<GameFolder> openGameFolder(std::string path);
   std::unique_ptr<GameFolder> openGameArchive(std::string path);
   size_t readFill(std::istream& in, const std::string& path,
@@ -0,0 +1,44 @@
+#ifndef MACHINEHH
+#define MACHINEHH
+
+#include "ars-emu.hh"
+#include "ppu.hh"
+#include "apu.hh"
+
+namespace ARS {
+  /* One whole console: the main board (with its CPU, cartridge, and
+     expansions), the PPU, and the APU. Any number of them can exist at once,
+     as long as each one is only run by one thread at a time.
+
+     Rather than being passed around, a machine is made current on a thread,
+     after which the bus, the CPU cores, the PPU, the APU, the mappers, and
+     the expansions called on that thread all work on it. (Threading a
+     Machine& through every memory access would cost a register in the
+     hottest code for the sake of the rare program that runs more than one.)
+
+     The frontend (the window, the speakers, the UI messages, the movie, the
+     rewind buffer, the captures, the floppy drives) only belongs to the
+     primary machine. Other machines run silently, and are only seen through
+     what their owner does with the frames they render. */
+  class Machine {
+  public:
+    MainBoard board;
+    PPU::State ppu;
+    APUState apu;
+    // big (the tile cache alone is 1MiB); make it with make_unique
+    explicit Machine(bool primary = false);
+    ~Machine();
+    Machine(const Machine&) = delete;
+    Machine& operator=(const Machine&) = delete;
+    // makes this the machine that everything on this thread works on
+    void makeCurrent();
+    // These work on the current machine, which must be this one. powerOn
+    // fills memory (and the APU) with garbage, as on a real power-on, drawn
+    // from garbage_source after seeding it with seed; reset needs a
+    // cartridge and a CPU.
+    void powerOn(uint32_t seed);
+    void reset();
+  };
+}
+
+#endif
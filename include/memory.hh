@@ -2,6 +2,7 @@
 #define MEMORYHH
 
 #include "ars-emu.hh"
+#include "savestate.hh"
 
 #include "teg.hh"
 
@@ -16,15 +17,33 @@ namespace ARS {
          || (size & mask) != 0)
         die("INTERNAL ERROR: Invalid memory size!");
     }
+    // for writable subclasses to use in freeze/defrost
+    void freezeContents(Freezer& f) {
+      f.layout(size);
+      f.bytes(memory_buffer, size);
+    }
+    void defrostContents(Defroster& d) {
+      d.layout(size);
+      d.bytes(memory_buffer, size);
+    }
   public:
     static constexpr uint32_t MAXIMUM_POSSIBLE_MEMORY_SIZE = 1 << 30;
     virtual ~Memory() = 0; // you must do the right thing vis memory_buffer!
     uint8_t read(uint32_t address) const { return memory_buffer[address&mask];}
+    // Host pointer to the bus page containing `address`, for the bus page
+    // table; nullptr if the memory is too small for a page to be contiguous.
+    const uint8_t* getPage(uint32_t address) const {
+      if(size < (1 << BUS_PAGE_SHIFT)) return nullptr;
+      return memory_buffer + (address & mask & ~uint32_t(BUS_PAGE_MASK));
+    }
     virtual void write(uint32_t address, uint8_t value) {
       ui << sn.Get("ROM_CHIP_WRITE"_Key, {TEG::format("%08X",address),
             TEG::format("%02X",value)}) << ui;
     }
     virtual void oncePerFrame() {}
+    // ROM has no state worth saving
+    virtual void freeze(Freezer&) {}
+    virtual void defrost(Defroster&) {}
   };
   inline Memory::~Memory() {} // comply! COMPLY!
   class WritableMemory : public Memory {
@@ -47,6 +66,12 @@ namespace ARS {
         if(--dirty == 0) flush();
       }
     }
+    void freeze(Freezer& f) override { freezeContents(f); }
+    void defrost(Defroster& d) override {
+      defrostContents(d);
+      // defrosting may have changed what belongs on disk
+      dirty = DIRTY_WRITE_DELAY;
+    }
   };
 }
 
@@ -0,0 +1,41 @@
+#ifndef MOVIEHH
+#define MOVIEHH
+
+#include "ars-emu.hh"
+
+namespace ARS {
+  /* Input movies, recorded at the level of what the controllers return to
+     the console on each falling edge of the strobe, rather than as host input
+     events. Replaying one feeds the console exactly the same bytes in exactly
+     the same order, so (given the same cartridge, options, and save files)
+     playback is bit-exact.
+
+     The file starts with "ARSMOVIE", a version byte, and the 32-bit
+     little-endian seed that was given to Machine::powerOn. The rest is a
+     series of runs, each of which is: the number of frames in the run, the
+     number of strobes in each of those frames, and then that many bytes, the
+     values read during each of those frames. The two counts are unsigned
+     LEB128. */
+  namespace Movie {
+    // both of these complain and return false if the file couldn't be used
+    bool startRecording(const std::string& path, uint32_t seed);
+    bool startPlayback(const std::string& path);
+    // only meaningful if isPlaying()
+    uint32_t getSeed();
+    bool isRecording();
+    bool isPlaying();
+    static inline bool isActive() { return isRecording() || isPlaying(); }
+    // true once a movie has been played to the end (and until the next one
+    // is started)
+    bool hasEnded();
+    // called by Controller whenever a strobe falls
+    void recordStrobe(uint8_t value);
+    uint8_t playStrobe();
+    // call once per emulated frame, between frames
+    void endFrame();
+    // finishes writing a recording, or abandons playback
+    void stop();
+  }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define PPUHH
 
 #include "ars-emu.hh"
+#include "savestate.hh"
 
 #include <array>
 
@@ -52,7 +53,7 @@ namespace ARS {
     constexpr int OVERLAY_TILES_WIDE = 32;
     constexpr int OVERLAY_TILES_HIGH = 28;
     constexpr int NUM_SPRITES = 64;
-    extern struct SpriteState {
+    struct SpriteState {
       // $0, $1; Y>240 = effectively disabled
       uint8_t X, Y;
       // $2: TTTTTFVH
@@ -66,22 +67,72 @@ namespace ARS {
       static constexpr uint8_t VFLIP_MASK = 2;
       static constexpr uint8_t FOREGROUND_MASK = 4;
       uint8_t TileAddr, TilePage;
-    } ssm[NUM_SPRITES];
-    static inline uint8_t* ssmBytes() {return reinterpret_cast<uint8_t*>(ssm);}
+    };
     static_assert(sizeof(SpriteState) == 4, "Sprite size has slipped");
     // HHHHHPPP
     // H = tile height-1, range 1..32 (8..128)
     typedef uint8_t SpriteAttr;
-    extern SpriteAttr sam[NUM_SPRITES];
-    static inline uint8_t* samBytes() {return sam;}
     constexpr uint8_t SA_HEIGHT_SHIFT = 3;
     constexpr uint8_t SA_HEIGHT_MASK = 0x1F;
     constexpr uint8_t SA_PALETTE_SHIFT = 0;
     constexpr uint8_t SA_PALETTE_MASK = 0x07;
-    extern uint8_t vram[0x10000];
-    extern uint8_t cram[0x100];
-    extern uint16_t vramAccessPtr;
-    extern uint8_t cramAccessPtr, ssmAccessPtr, samAccessPtr;
+    static_assert(NUM_SPRITES <= 64, "sprite_bins entries are too narrow");
+    /* Byte n of an entry is bit 7-n of its index; that is, one plane of a tile
+       row, spread out into one byte per pixel with the leftmost pixel first in
+       memory. Two or three of these ORed together (with shifts) give eight
+       pixels' worth of color indices at once. */
+    constexpr uint64_t EVERY_BYTE = 0x0101010101010101;
+    extern const struct SpreadTable {
+      uint64_t entries[256];
+      SpreadTable();
+      uint64_t operator[](uint8_t plane) const { return entries[plane]; }
+    } spread_bits;
+    /* Cache of VRAM rows decoded with spread_bits, indexed by the address of
+       the row's first plane. Decoded lazily, one 8-row group at a time, and
+       invalidated by markVramDirty, which everything that writes to VRAM
+       must call. */
+    namespace TileCache {
+      constexpr uint8_t ROWS2_VALID = 1, ROWS3_VALID = 2;
+      struct Rows {
+        // first plane at n, second at n+8 (background tiles)
+        uint64_t rows2[0x10000];
+        // planes at n, n+8, and n+16 (sprite tiles)
+        uint64_t rows3[0x10000];
+        uint8_t group_valid[0x10000 >> 3];
+      };
+      void decodeGroup2(unsigned int group);
+      void decodeGroup3(unsigned int group);
+    }
+    /* Everything one PPU remembers. Each Machine has its own; the functions
+       in this namespace work on the one belonging to the current thread's
+       machine (see machine.hh). */
+    struct State {
+      SpriteState ssm[NUM_SPRITES];
+      SpriteAttr sam[NUM_SPRITES];
+      uint8_t vram[0x10000];
+      uint8_t cram[0x100];
+      uint16_t vramAccessPtr;
+      uint8_t cramAccessPtr, ssmAccessPtr, samAccessPtr;
+      int cur_scanline = LIVE_SCREEN_HEIGHT;
+      // layers can be hidden, for debugging
+      bool show_overlay = true, show_sprites = true, show_background = true;
+      // Bit n of sprite_bins[scanline] is set if sprite n covers that
+      // scanline. Kept current by every write to SSM or SAM; debug builds
+      // check it against the sprites on every scanline they render.
+      uint64_t sprite_bins[LIVE_SCREEN_HEIGHT];
+      // the scanlines each sprite is currently binned on, [top, bottom)
+      int binned_top[NUM_SPRITES], binned_bottom[NUM_SPRITES];
+      TileCache::Rows tile_cache;
+    };
+    extern __thread State* state;
+    static inline uint8_t* ssmBytes() {
+      return reinterpret_cast<uint8_t*>(state->ssm);
+    }
+    static inline uint8_t* samBytes() {return state->sam;}
+    void rebinSprite(int n);
+    void rebinAllSprites();
+    // true if sprite_bins[scanline] agrees with SSM and SAM
+    bool spriteBinIsCurrent(int scanline);
     struct Background_Mode1 {
       uint8_t Tiles[MODE1_BACKGROUND_TILES_WIDE * MODE1_BACKGROUND_TILES_HIGH];
       uint8_t Attributes[MODE1_BACKGROUND_TILES_WIDE
@@ -89,13 +140,13 @@ namespace ARS {
       uint8_t padding[4];
     };
     static inline struct Background_Mode1* backgrounds_mode1() {
-      return reinterpret_cast<struct Background_Mode1*>(vram);
+      return reinterpret_cast<struct Background_Mode1*>(state->vram);
     }
     struct Background_Mode2 {
       uint8_t Tiles[MODE2_BACKGROUND_TILES_WIDE * MODE2_BACKGROUND_TILES_HIGH];
     };
     static inline struct Background_Mode2* backgrounds_mode2() {
-      return reinterpret_cast<struct Background_Mode2*>(vram);
+      return reinterpret_cast<struct Background_Mode2*>(state->vram);
     }
     static_assert(sizeof(Background_Mode1)==0x400, "Background size slipped");
     static_assert(sizeof(Background_Mode2)==0x400, "Background size slipped");
@@ -105,7 +156,8 @@ namespace ARS {
       uint8_t padding[16];
     };
     static inline struct Overlay& overlay() {
-      return *reinterpret_cast<struct Overlay*>(ARS::dram+sizeof(ARS::dram)
+      return *reinterpret_cast<struct Overlay*>(ARS::board->dram
+                                                +sizeof(ARS::board->dram)
                                                 -sizeof(struct Overlay));
     }
     static_assert(sizeof(Overlay) == 0x400, "Overlay size has slipped");
@@ -117,7 +169,26 @@ namespace ARS {
     void fillWithGarbage();
     void handleReset();
     void dumpSpriteMemory();
-    extern bool show_overlay, show_sprites, show_background;
+    void freeze(Freezer&);
+    void defrost(Defroster&);
+    // render a pixel at a time, the slow (original) way, instead of a tile at a
+    // time; only useful for checking that the two still agree
+    extern bool use_pixel_renderer;
+    static inline uint64_t getDecodedRow2(uint16_t addr) {
+      auto& cache = state->tile_cache;
+      if(!(cache.group_valid[addr>>3] & TileCache::ROWS2_VALID))
+        TileCache::decodeGroup2(addr>>3);
+      return cache.rows2[addr];
+    }
+    // a horizontally flipped row is the same row with its bytes reversed
+    static inline uint64_t getDecodedRow3(uint16_t addr, bool hflip) {
+      auto& cache = state->tile_cache;
+      if(!(cache.group_valid[addr>>3] & TileCache::ROWS3_VALID))
+        TileCache::decodeGroup3(addr>>3);
+      return hflip ? __builtin_bswap64(cache.rows3[addr]) : cache.rows3[addr];
+    }
+    void markVramDirty(uint16_t addr);
+    void markAllVramDirty();
     // $0211, $0213, $0215, $0217
     uint8_t complexRead(uint16_t addr);
     // $0210-$021F
@@ -0,0 +1,76 @@
+#ifndef PRESENTERHH
+#define PRESENTERHH
+
+#include "ppu.hh"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace ARS {
+  /* Lock-free handoff of the newest of a stream of values, from exactly one
+     producer thread to exactly one consumer thread. The producer always has a
+     buffer of its own to fill, the consumer always gets the most recently
+     published one, and neither ever waits for the other. Frames the consumer
+     doesn't get to in time are simply overwritten. */
+  template<class T> class TripleBuffer {
+    static constexpr uint8_t INDEX_MASK = 3, FRESH = 4;
+    T buffers[3];
+    // index of the buffer in the middle, plus FRESH if it was published since
+    // the consumer last took one
+    std::atomic<uint8_t> middle{1};
+    uint8_t back = 0; // producer's
+    uint8_t front = 2; // consumer's
+  public:
+    // producer side
+    T& backBuffer() { return buffers[back]; }
+    void publish() {
+      back = middle.exchange(back | FRESH, std::memory_order_acq_rel)
+        & INDEX_MASK;
+    }
+    // consumer side; returns nullptr if nothing new has been published
+    T* take() {
+      if(!(middle.load(std::memory_order_acquire) & FRESH)) return nullptr;
+      front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+      return &buffers[front];
+    }
+    // either side, while the other thread isn't running
+    T& operator[](int n) { return buffers[n]; }
+  };
+  /* Runs a display's expensive per-frame work (the FX chain) on its own
+     thread, one frame behind emulation. The emulation thread submits each
+     raw_screen and picks up whatever prepared frame is newest; the presenter
+     thread turns raw_screens into prepared frames as fast as they come.
+     Without FX threads, or if the thread can't be made, each frame is
+     prepared right away in submit instead. */
+  class Presenter {
+  public:
+    typedef std::function<void(const PPU::raw_screen& in, uint8_t* out)>
+    PrepareFunc;
+    Presenter(size_t prepared_size, PrepareFunc prepare);
+    // waits for the current frame (if any) to finish preparing
+    ~Presenter();
+    // emulation thread only
+    void submit(const PPU::raw_screen& frame);
+    // emulation thread only; returns nullptr if no frame has been prepared
+    // since the last call
+    const uint8_t* takePrepared();
+  private:
+    Presenter(const Presenter&) = delete;
+    Presenter(Presenter&&) = delete;
+    Presenter& operator=(const Presenter&) = delete;
+    Presenter& operator=(Presenter&&) = delete;
+    PrepareFunc prepare;
+    TripleBuffer<PPU::raw_screen> frames;
+    TripleBuffer<std::vector<uint8_t>> prepared;
+    std::atomic<bool> quitting{false};
+    SDL_sem* wake;
+    SDL_Thread* thread;
+    int body();
+    static int outer_body(void* p) {
+      return reinterpret_cast<Presenter*>(p)->body();
+    }
+  };
+}
+
+#endif
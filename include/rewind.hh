@@ -0,0 +1,20 @@
+#ifndef REWINDHH
+#define REWINDHH
+
+#include "ars-emu.hh"
+
+namespace ARS {
+  namespace Rewind {
+    // Sets how much history to keep. 0 disables rewind (and frees the arena).
+    // Discards any existing history.
+    void setHistoryLength(unsigned int seconds);
+    // Call once per emulated frame, between frames. Cheap when disabled.
+    void captureFrame();
+    // Steps back up to `frames` frames and restores the machine to that point.
+    // Returns false if there was no older state to go back to.
+    bool stepBack(unsigned int frames);
+    void clear();
+  }
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SAVESTATEHH
+#define SAVESTATEHH
+
+#include "ars-emu.hh"
+
+#include <vector>
+#include <type_traits>
+
+/*
+
+  A frozen machine is one contiguous blob: a small header (magic number,
+  format version, and a hash of the values passed to Freezer::layout),
+  followed by each component's state, in a fixed order, in host byte
+  order. There are no per-field tags; any change to what a component
+  saves, or to the order in which it saves it, MUST bump FORMAT_VERSION.
+
+  Components describe their state once, in a template member that takes an
+  "archive" and calls it on each field. Freezer copies those fields into the
+  blob, Defroster copies them back out. Only trivially copyable fields may be
+  passed this way.
+
+  A blob is only meaningful to the session that froze it: same cartridge, same
+  core, same expansions.
+
+ */
+
+namespace ARS {
+  class Freezer {
+    std::vector<uint8_t>* out;
+    size_t length = 0;
+    uint64_t layout_hash = 0xCBF29CE484222325ULL;
+  public:
+    // Existing capacity is reused, so a caller that freezes repeatedly into
+    // the same vector only allocates the first time.
+    Freezer(std::vector<uint8_t>& out) : out(&out) { out.clear(); }
+    // Copies nothing, only measuring the blob and hashing its layout.
+    Freezer() : out(nullptr) {}
+    void bytes(const void* p, size_t len) {
+      length += len;
+      if(out == nullptr) return;
+      auto q = reinterpret_cast<const uint8_t*>(p);
+      out->insert(out->end(), q, q + len);
+    }
+    template<class T> void operator()(const T& value) {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "only trivially copyable state can be frozen directly");
+      bytes(&value, sizeof(value));
+    }
+    // For values that decide how the rest of the blob is laid out (a
+    // memory's size, whether an expansion is there). A blob is only
+    // defrosted if all of these match the machine's.
+    template<class T> void layout(const T& value) {
+      (*this)(value);
+      auto q = reinterpret_cast<const uint8_t*>(&value);
+      for(size_t n = 0; n < sizeof(value); ++n)
+        layout_hash = (layout_hash ^ q[n]) * 0x100000001B3ULL;
+    }
+    size_t getLength() const { return length; }
+    uint64_t getLayoutHash() const { return layout_hash; }
+  };
+  class Defroster {
+    const uint8_t* p, *end;
+  public:
+    Defroster(const uint8_t* p, size_t len) : p(p), end(p + len) {}
+    // throws a std::string if the blob runs out early
+    void bytes(void* dst, size_t len) {
+      if(static_cast<size_t>(end - p) < len)
+        throw sn.Get("DEFROST_BAD_STATE"_Key);
+      memcpy(dst, p, len);
+      p += len;
+    }
+    template<class T> void operator()(T& value) {
+      static_assert(std::is_trivially_copyable<T>::value,
+                    "only trivially copyable state can be defrosted directly");
+      bytes(&value, sizeof(value));
+    }
+    // the other side of Freezer::layout; throws a std::string if the blob's
+    // value isn't `expected`
+    template<class T> void layout(const T& expected) {
+      T frozen;
+      (*this)(frozen);
+      if(memcmp(&frozen, &expected, sizeof(T)))
+        throw sn.Get("DEFROST_WRONG_CARTRIDGE"_Key);
+    }
+    bool atEnd() const { return p == end; }
+  };
+  // Captures the entire emulated machine into `out`. Must be called between
+  // frames.
+  void freezeMachine(std::vector<uint8_t>& out);
+  // Restores a blob made by freezeMachine. Throws a (localized) std::string if
+  // the blob is the wrong version, is truncated, or doesn't match the current
+  // session, in which case the machine is left as it was.
+  void defrostMachine(const uint8_t* blob, size_t len);
+  // Implemented in ars-emu.cc: DRAM, bank map, and other main-board latches
+  void freezeMainBoard(Freezer&);
+  void defrostMainBoard(Defroster&);
+}
+
+#endif
@@ -1005,272 +1005,279 @@ namespace W65C02 {
           pc = system.fetch_vector_byte(IRQ_VECTOR);
           pc |= system.fetch_vector_byte(IRQ_VECTOR+1)<<8;
         }
-        else {
-          uint8_t opcode = system.read_opcode(read_pc_postincrement(),
-                                              ReadType::OPCODE);
-          switch(opcode) {
-          case 0x00: BRK(); break;
-          case 0x01: ORA<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0x02: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0x03: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x04: TSB<AM::ZeroPage<Core<System>>>(); break;
-          case 0x05: ORA<AM::ZeroPage<Core<System>>>(); break;
-          case 0x06: ASL<AM::ZeroPage<Core<System>>>(); break;
-          case 0x07: RMB<AM::ZeroPage<Core<System>>,0>(); break;
-          case 0x08: PHP(); break;
-          case 0x09: ORA<AM::Immediate<Core<System>>>(); break;
-          case 0x0A: ASL<AM::ImpliedA<Core<System>>>(); break;
-          case 0x0B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x0C: TSB<AM::Absolute<Core<System>>>(); break;
-          case 0x0D: ORA<AM::Absolute<Core<System>>>(); break;
-          case 0x0E: ASL<AM::Absolute<Core<System>>>(); break;
-          case 0x0F: BBR<AM::RelativeBitBranch<Core<System>>,0>(); break;
-          case 0x10: Branch<AM::Relative<Core<System>>,P_N,0>(); break;
-          case 0x11: ORA<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0x12: ORA<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0x13: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x14: TRB<AM::ZeroPage<Core<System>>>(); break;
-          case 0x15: ORA<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x16: ASL<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x17: RMB<AM::ZeroPage<Core<System>>,1>(); break;
-          case 0x18: CLC(); break;
-          case 0x19: ORA<AM::AbsoluteY<Core<System>>>(); break;
-          case 0x1A: INC<AM::ImpliedA<Core<System>>>(); break;
-          case 0x1B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x1C: TRB<AM::Absolute<Core<System>>>(); break;
-          case 0x1D: ORA<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x1E: ASL<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x1F: BBR<AM::RelativeBitBranch<Core<System>>,1>(); break;
-          case 0x20: JSR(); break;
-          case 0x21: AND<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0x22: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0x23: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x24: BIT<AM::ZeroPage<Core<System>>>(); break;
-          case 0x25: AND<AM::ZeroPage<Core<System>>>(); break;
-          case 0x26: ROL<AM::ZeroPage<Core<System>>>(); break;
-          case 0x27: RMB<AM::ZeroPage<Core<System>>,2>(); break;
-          case 0x28: PLP(); break;
-          case 0x29: AND<AM::Immediate<Core<System>>>(); break;
-          case 0x2A: ROL<AM::ImpliedA<Core<System>>>(); break;
-          case 0x2B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x2C: BIT<AM::Absolute<Core<System>>>(); break;
-          case 0x2D: AND<AM::Absolute<Core<System>>>(); break;
-          case 0x2E: ROL<AM::Absolute<Core<System>>>(); break;
-          case 0x2F: BBR<AM::RelativeBitBranch<Core<System>>,2>(); break;
-          case 0x30: Branch<AM::Relative<Core<System>>,P_N,P_N>(); break;
-          case 0x31: AND<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0x32: AND<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0x33: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x34: BIT<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x35: AND<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x36: ROL<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x37: RMB<AM::ZeroPage<Core<System>>,3>(); break;
-          case 0x38: SEC(); break;
-          case 0x39: AND<AM::AbsoluteY<Core<System>>>(); break;
-          case 0x3A: DEC<AM::ImpliedA<Core<System>>>(); break;
-          case 0x3B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x3C: BIT<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x3D: AND<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x3E: ROL<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x3F: BBR<AM::RelativeBitBranch<Core<System>>,3>(); break;
-          case 0x40: RTI(); break;
-          case 0x41: EOR<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0x42: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0x43: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x44: NOP<AM::ZeroPage<Core<System>>>(); break;
-          case 0x45: EOR<AM::ZeroPage<Core<System>>>(); break;
-          case 0x46: LSR<AM::ZeroPage<Core<System>>>(); break;
-          case 0x47: RMB<AM::ZeroPage<Core<System>>,4>(); break;
-          case 0x48: PHA(); break;
-          case 0x49: EOR<AM::Immediate<Core<System>>>(); break;
-          case 0x4A: LSR<AM::ImpliedA<Core<System>>>(); break;
-          case 0x4B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x4C: JMP<AM::Absolute<Core<System>>>(); break;
-          case 0x4D: EOR<AM::Absolute<Core<System>>>(); break;
-          case 0x4E: LSR<AM::Absolute<Core<System>>>(); break;
-          case 0x4F: BBR<AM::RelativeBitBranch<Core<System>>,4>(); break;
-          case 0x50: Branch<AM::Relative<Core<System>>,P_V,0>(); break;
-          case 0x51: EOR<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0x52: EOR<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0x53: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x54: NOP<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x55: EOR<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x56: LSR<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x57: RMB<AM::ZeroPage<Core<System>>,5>(); break;
-          case 0x58: CLI(); break;
-          case 0x59: EOR<AM::AbsoluteY<Core<System>>>(); break;
-          case 0x5A: PHY(); break;
-          case 0x5B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x5C: NOP_5C<AM::Absolute<Core<System>>>(); break;
-          case 0x5D: EOR<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x5E: LSR<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x5F: BBR<AM::RelativeBitBranch<Core<System>>,5>(); break;
-          case 0x60: RTS(); break;
-          case 0x61: ADC<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0x62: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0x63: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x64: STZ<AM::ZeroPage<Core<System>>>(); break;
-          case 0x65: ADC<AM::ZeroPage<Core<System>>>(); break;
-          case 0x66: ROR<AM::ZeroPage<Core<System>>>(); break;
-          case 0x67: RMB<AM::ZeroPage<Core<System>>,6>(); break;
-          case 0x68: PLA(); break;
-          case 0x69: ADC<AM::Immediate<Core<System>>>(); break;
-          case 0x6A: ROR<AM::ImpliedA<Core<System>>>(); break;
-          case 0x6B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x6C: JMP<AM::AbsoluteIndirect<Core<System>>>(); break;
-          case 0x6D: ADC<AM::Absolute<Core<System>>>(); break;
-          case 0x6E: ROR<AM::Absolute<Core<System>>>(); break;
-          case 0x6F: BBR<AM::RelativeBitBranch<Core<System>>,6>(); break;
-          case 0x70: Branch<AM::Relative<Core<System>>,P_V,P_V>(); break;
-          case 0x71: ADC<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0x72: ADC<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0x73: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x74: STZ<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x75: ADC<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x76: ROR<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x77: RMB<AM::ZeroPage<Core<System>>,7>(); break;
-          case 0x78: SEI(); break;
-          case 0x79: ADC<AM::AbsoluteY<Core<System>>>(); break;
-          case 0x7A: PLY(); break;
-          case 0x7B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x7C: JMP<AM::AbsoluteXIndirect<Core<System>>>(); break;
-          case 0x7D: ADC<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x7E: ROR<AM::AbsoluteX<Core<System>>>(); break;
-          case 0x7F: BBR<AM::RelativeBitBranch<Core<System>>,7>(); break;
-          case 0x80: Branch<AM::Relative<Core<System>>,0,0>(); break;
-          case 0x81: STA<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0x82: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0x83: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x84: STY<AM::ZeroPage<Core<System>>>(); break;
-          case 0x85: STA<AM::ZeroPage<Core<System>>>(); break;
-          case 0x86: STX<AM::ZeroPage<Core<System>>>(); break;
-          case 0x87: SMB<AM::ZeroPage<Core<System>>,0>(); break;
-          case 0x88: DEC<AM::ImpliedY<Core<System>>>(); break;
-          case 0x89: BIT_I<AM::Immediate<Core<System>>>(); break;
-          case 0x8A: TXA(); break;
-          case 0x8B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x8C: STY<AM::Absolute<Core<System>>>(); break;
-          case 0x8D: STA<AM::Absolute<Core<System>>>(); break;
-          case 0x8E: STX<AM::Absolute<Core<System>>>(); break;
-          case 0x8F: BBS<AM::RelativeBitBranch<Core<System>>,0>(); break;
-          case 0x90: Branch<AM::Relative<Core<System>>,P_C,0>(); break;
-          case 0x91: STA<AM::ZeroPageIndirectYBug<Core<System>>>(); break;
-          case 0x92: STA<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0x93: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x94: STY<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x95: STA<AM::ZeroPageX<Core<System>>>(); break;
-          case 0x96: STX<AM::ZeroPageY<Core<System>>>(); break;
-          case 0x97: SMB<AM::ZeroPage<Core<System>>,1>(); break;
-          case 0x98: TYA(); break;
-          case 0x99: STA<AM::AbsoluteYBug<Core<System>>>(); break;
-          case 0x9A: TXS(); break;
-          case 0x9B: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0x9C: STZ<AM::Absolute<Core<System>>>(); break;
-          case 0x9D: STA<AM::AbsoluteXBug<Core<System>>>(); break;
-          case 0x9E: STZ<AM::AbsoluteXBug<Core<System>>>(); break;
-          case 0x9F: BBS<AM::RelativeBitBranch<Core<System>>,1>(); break;
-          case 0xA0: LDY<AM::Immediate<Core<System>>>(); break;
-          case 0xA1: LDA<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0xA2: LDX<AM::Immediate<Core<System>>>(); break;
-          case 0xA3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xA4: LDY<AM::ZeroPage<Core<System>>>(); break;
-          case 0xA5: LDA<AM::ZeroPage<Core<System>>>(); break;
-          case 0xA6: LDX<AM::ZeroPage<Core<System>>>(); break;
-          case 0xA7: SMB<AM::ZeroPage<Core<System>>,2>(); break;
-          case 0xA8: TAY(); break;
-          case 0xA9: LDA<AM::Immediate<Core<System>>>(); break;
-          case 0xAA: TAX(); break;
-          case 0xAB: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xAC: LDY<AM::Absolute<Core<System>>>(); break;
-          case 0xAD: LDA<AM::Absolute<Core<System>>>(); break;
-          case 0xAE: LDX<AM::Absolute<Core<System>>>(); break;
-          case 0xAF: BBS<AM::RelativeBitBranch<Core<System>>,2>(); break;
-          case 0xB0: Branch<AM::Relative<Core<System>>,P_C,P_C>(); break;
-          case 0xB1: LDA<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0xB2: LDA<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0xB3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xB4: LDY<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xB5: LDA<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xB6: LDX<AM::ZeroPageY<Core<System>>>(); break;
-          case 0xB7: SMB<AM::ZeroPage<Core<System>>,3>(); break;
-          case 0xB8: CLV(); break;
-          case 0xB9: LDA<AM::AbsoluteY<Core<System>>>(); break;
-          case 0xBA: TSX(); break;
-          case 0xBB: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xBC: LDY<AM::AbsoluteX<Core<System>>>(); break;
-          case 0xBD: LDA<AM::AbsoluteX<Core<System>>>(); break;
-          case 0xBE: LDX<AM::AbsoluteY<Core<System>>>(); break;
-          case 0xBF: BBS<AM::RelativeBitBranch<Core<System>>,3>(); break;
-          case 0xC0: CPY<AM::Immediate<Core<System>>>(); break;
-          case 0xC1: CMP<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0xC2: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0xC3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xC4: CPY<AM::ZeroPage<Core<System>>>(); break;
-          case 0xC5: CMP<AM::ZeroPage<Core<System>>>(); break;
-          case 0xC6: DEC<AM::ZeroPage<Core<System>>>(); break;
-          case 0xC7: SMB<AM::ZeroPage<Core<System>>,4>(); break;
-          case 0xC8: INC<AM::ImpliedY<Core<System>>>(); break;
-          case 0xC9: CMP<AM::Immediate<Core<System>>>(); break;
-          case 0xCA: DEC<AM::ImpliedX<Core<System>>>(); break;
-          case 0xCB: WAI(); break;
-          case 0xCC: CPY<AM::Absolute<Core<System>>>(); break;
-          case 0xCD: CMP<AM::Absolute<Core<System>>>(); break;
-          case 0xCE: DEC<AM::Absolute<Core<System>>>(); break;
-          case 0xCF: BBS<AM::RelativeBitBranch<Core<System>>,4>(); break;
-          case 0xD0: Branch<AM::Relative<Core<System>>,P_Z,0>(); break;
-          case 0xD1: CMP<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0xD2: CMP<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0xD3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xD4: NOP<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xD5: CMP<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xD6: DEC<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xD7: SMB<AM::ZeroPage<Core<System>>,5>(); break;
-          case 0xD8: CLD(); break;
-          case 0xD9: CMP<AM::AbsoluteY<Core<System>>>(); break;
-          case 0xDA: PHX(); break;
-          case 0xDB: STP(); break;
-          case 0xDC: NOP<AM::Absolute<Core<System>>>(); break;
-          case 0xDD: CMP<AM::AbsoluteX<Core<System>>>(); break;
-          case 0xDE: DEC<AM::AbsoluteXBug<Core<System>>>(); break;
-          case 0xDF: BBS<AM::RelativeBitBranch<Core<System>>,5>(); break;
-          case 0xE0: CPX<AM::Immediate<Core<System>>>(); break;
-          case 0xE1: SBC<AM::ZeroPageXIndirect<Core<System>>>(); break;
-          case 0xE2: NOP<AM::Immediate<Core<System>>>(); break;
-          case 0xE3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xE4: CPX<AM::ZeroPage<Core<System>>>(); break;
-          case 0xE5: SBC<AM::ZeroPage<Core<System>>>(); break;
-          case 0xE6: INC<AM::ZeroPage<Core<System>>>(); break;
-          case 0xE7: SMB<AM::ZeroPage<Core<System>>,6>(); break;
-          case 0xE8: INC<AM::ImpliedX<Core<System>>>(); break;
-          case 0xE9: SBC<AM::Immediate<Core<System>>>(); break;
-          case 0xEA: NOP<AM::Implied<Core<System>>>(); break;
-          case 0xEB: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xEC: CPX<AM::Absolute<Core<System>>>(); break;
-          case 0xED: SBC<AM::Absolute<Core<System>>>(); break;
-          case 0xEE: INC<AM::Absolute<Core<System>>>(); break;
-          case 0xEF: BBS<AM::RelativeBitBranch<Core<System>>,6>(); break;
-          case 0xF0: Branch<AM::Relative<Core<System>>,P_Z,P_Z>(); break;
-          case 0xF1: SBC<AM::ZeroPageIndirectY<Core<System>>>(); break;
-          case 0xF2: SBC<AM::ZeroPageIndirect<Core<System>>>(); break;
-          case 0xF3: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xF4: NOP<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xF5: SBC<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xF6: INC<AM::ZeroPageX<Core<System>>>(); break;
-          case 0xF7: SMB<AM::ZeroPage<Core<System>>,7>(); break;
-          case 0xF8: SED(); break;
-          case 0xF9: SBC<AM::AbsoluteY<Core<System>>>(); break;
-          case 0xFA: PLX(); break;
-          case 0xFB: NOP<AM::SuperImplied<Core<System>>>(); break;
-          case 0xFC: NOP<AM::Absolute<Core<System>>>(); break;
-          case 0xFD: SBC<AM::AbsoluteX<Core<System>>>(); break;
-          case 0xFE: INC<AM::AbsoluteXBug<Core<System>>>(); break;
-          case 0xFF: BBS<AM::RelativeBitBranch<Core<System>>,7>(); break;
-          }
-        }
+        else
+          execute(system.read_opcode(read_pc_postincrement(),
+                                     ReadType::OPCODE));
       } break;
       }
       return state == State::AWAITING_INTERRUPT || state == State::STOPPED;
     }
+    // true if step() would do nothing but fetch an opcode and execute it
+    bool ready_for_opcode() {
+      return state == State::RUNNING && !so_edge && !nmi_pending && !irq_edge;
+    }
+    // carries out the instruction whose opcode was just fetched (PC already
+    // points past it)
+    __attribute__((always_inline)) void execute(uint8_t opcode) {
+      switch(opcode) {
+      case 0x00: BRK(); break;
+      case 0x01: ORA<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0x02: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0x03: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x04: TSB<AM::ZeroPage<Core<System>>>(); break;
+      case 0x05: ORA<AM::ZeroPage<Core<System>>>(); break;
+      case 0x06: ASL<AM::ZeroPage<Core<System>>>(); break;
+      case 0x07: RMB<AM::ZeroPage<Core<System>>,0>(); break;
+      case 0x08: PHP(); break;
+      case 0x09: ORA<AM::Immediate<Core<System>>>(); break;
+      case 0x0A: ASL<AM::ImpliedA<Core<System>>>(); break;
+      case 0x0B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x0C: TSB<AM::Absolute<Core<System>>>(); break;
+      case 0x0D: ORA<AM::Absolute<Core<System>>>(); break;
+      case 0x0E: ASL<AM::Absolute<Core<System>>>(); break;
+      case 0x0F: BBR<AM::RelativeBitBranch<Core<System>>,0>(); break;
+      case 0x10: Branch<AM::Relative<Core<System>>,P_N,0>(); break;
+      case 0x11: ORA<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0x12: ORA<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0x13: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x14: TRB<AM::ZeroPage<Core<System>>>(); break;
+      case 0x15: ORA<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x16: ASL<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x17: RMB<AM::ZeroPage<Core<System>>,1>(); break;
+      case 0x18: CLC(); break;
+      case 0x19: ORA<AM::AbsoluteY<Core<System>>>(); break;
+      case 0x1A: INC<AM::ImpliedA<Core<System>>>(); break;
+      case 0x1B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x1C: TRB<AM::Absolute<Core<System>>>(); break;
+      case 0x1D: ORA<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x1E: ASL<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x1F: BBR<AM::RelativeBitBranch<Core<System>>,1>(); break;
+      case 0x20: JSR(); break;
+      case 0x21: AND<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0x22: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0x23: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x24: BIT<AM::ZeroPage<Core<System>>>(); break;
+      case 0x25: AND<AM::ZeroPage<Core<System>>>(); break;
+      case 0x26: ROL<AM::ZeroPage<Core<System>>>(); break;
+      case 0x27: RMB<AM::ZeroPage<Core<System>>,2>(); break;
+      case 0x28: PLP(); break;
+      case 0x29: AND<AM::Immediate<Core<System>>>(); break;
+      case 0x2A: ROL<AM::ImpliedA<Core<System>>>(); break;
+      case 0x2B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x2C: BIT<AM::Absolute<Core<System>>>(); break;
+      case 0x2D: AND<AM::Absolute<Core<System>>>(); break;
+      case 0x2E: ROL<AM::Absolute<Core<System>>>(); break;
+      case 0x2F: BBR<AM::RelativeBitBranch<Core<System>>,2>(); break;
+      case 0x30: Branch<AM::Relative<Core<System>>,P_N,P_N>(); break;
+      case 0x31: AND<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0x32: AND<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0x33: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x34: BIT<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x35: AND<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x36: ROL<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x37: RMB<AM::ZeroPage<Core<System>>,3>(); break;
+      case 0x38: SEC(); break;
+      case 0x39: AND<AM::AbsoluteY<Core<System>>>(); break;
+      case 0x3A: DEC<AM::ImpliedA<Core<System>>>(); break;
+      case 0x3B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x3C: BIT<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x3D: AND<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x3E: ROL<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x3F: BBR<AM::RelativeBitBranch<Core<System>>,3>(); break;
+      case 0x40: RTI(); break;
+      case 0x41: EOR<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0x42: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0x43: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x44: NOP<AM::ZeroPage<Core<System>>>(); break;
+      case 0x45: EOR<AM::ZeroPage<Core<System>>>(); break;
+      case 0x46: LSR<AM::ZeroPage<Core<System>>>(); break;
+      case 0x47: RMB<AM::ZeroPage<Core<System>>,4>(); break;
+      case 0x48: PHA(); break;
+      case 0x49: EOR<AM::Immediate<Core<System>>>(); break;
+      case 0x4A: LSR<AM::ImpliedA<Core<System>>>(); break;
+      case 0x4B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x4C: JMP<AM::Absolute<Core<System>>>(); break;
+      case 0x4D: EOR<AM::Absolute<Core<System>>>(); break;
+      case 0x4E: LSR<AM::Absolute<Core<System>>>(); break;
+      case 0x4F: BBR<AM::RelativeBitBranch<Core<System>>,4>(); break;
+      case 0x50: Branch<AM::Relative<Core<System>>,P_V,0>(); break;
+      case 0x51: EOR<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0x52: EOR<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0x53: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x54: NOP<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x55: EOR<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x56: LSR<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x57: RMB<AM::ZeroPage<Core<System>>,5>(); break;
+      case 0x58: CLI(); break;
+      case 0x59: EOR<AM::AbsoluteY<Core<System>>>(); break;
+      case 0x5A: PHY(); break;
+      case 0x5B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x5C: NOP_5C<AM::Absolute<Core<System>>>(); break;
+      case 0x5D: EOR<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x5E: LSR<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x5F: BBR<AM::RelativeBitBranch<Core<System>>,5>(); break;
+      case 0x60: RTS(); break;
+      case 0x61: ADC<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0x62: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0x63: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x64: STZ<AM::ZeroPage<Core<System>>>(); break;
+      case 0x65: ADC<AM::ZeroPage<Core<System>>>(); break;
+      case 0x66: ROR<AM::ZeroPage<Core<System>>>(); break;
+      case 0x67: RMB<AM::ZeroPage<Core<System>>,6>(); break;
+      case 0x68: PLA(); break;
+      case 0x69: ADC<AM::Immediate<Core<System>>>(); break;
+      case 0x6A: ROR<AM::ImpliedA<Core<System>>>(); break;
+      case 0x6B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x6C: JMP<AM::AbsoluteIndirect<Core<System>>>(); break;
+      case 0x6D: ADC<AM::Absolute<Core<System>>>(); break;
+      case 0x6E: ROR<AM::Absolute<Core<System>>>(); break;
+      case 0x6F: BBR<AM::RelativeBitBranch<Core<System>>,6>(); break;
+      case 0x70: Branch<AM::Relative<Core<System>>,P_V,P_V>(); break;
+      case 0x71: ADC<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0x72: ADC<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0x73: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x74: STZ<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x75: ADC<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x76: ROR<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x77: RMB<AM::ZeroPage<Core<System>>,7>(); break;
+      case 0x78: SEI(); break;
+      case 0x79: ADC<AM::AbsoluteY<Core<System>>>(); break;
+      case 0x7A: PLY(); break;
+      case 0x7B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x7C: JMP<AM::AbsoluteXIndirect<Core<System>>>(); break;
+      case 0x7D: ADC<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x7E: ROR<AM::AbsoluteX<Core<System>>>(); break;
+      case 0x7F: BBR<AM::RelativeBitBranch<Core<System>>,7>(); break;
+      case 0x80: Branch<AM::Relative<Core<System>>,0,0>(); break;
+      case 0x81: STA<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0x82: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0x83: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x84: STY<AM::ZeroPage<Core<System>>>(); break;
+      case 0x85: STA<AM::ZeroPage<Core<System>>>(); break;
+      case 0x86: STX<AM::ZeroPage<Core<System>>>(); break;
+      case 0x87: SMB<AM::ZeroPage<Core<System>>,0>(); break;
+      case 0x88: DEC<AM::ImpliedY<Core<System>>>(); break;
+      case 0x89: BIT_I<AM::Immediate<Core<System>>>(); break;
+      case 0x8A: TXA(); break;
+      case 0x8B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x8C: STY<AM::Absolute<Core<System>>>(); break;
+      case 0x8D: STA<AM::Absolute<Core<System>>>(); break;
+      case 0x8E: STX<AM::Absolute<Core<System>>>(); break;
+      case 0x8F: BBS<AM::RelativeBitBranch<Core<System>>,0>(); break;
+      case 0x90: Branch<AM::Relative<Core<System>>,P_C,0>(); break;
+      case 0x91: STA<AM::ZeroPageIndirectYBug<Core<System>>>(); break;
+      case 0x92: STA<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0x93: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x94: STY<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x95: STA<AM::ZeroPageX<Core<System>>>(); break;
+      case 0x96: STX<AM::ZeroPageY<Core<System>>>(); break;
+      case 0x97: SMB<AM::ZeroPage<Core<System>>,1>(); break;
+      case 0x98: TYA(); break;
+      case 0x99: STA<AM::AbsoluteYBug<Core<System>>>(); break;
+      case 0x9A: TXS(); break;
+      case 0x9B: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0x9C: STZ<AM::Absolute<Core<System>>>(); break;
+      case 0x9D: STA<AM::AbsoluteXBug<Core<System>>>(); break;
+      case 0x9E: STZ<AM::AbsoluteXBug<Core<System>>>(); break;
+      case 0x9F: BBS<AM::RelativeBitBranch<Core<System>>,1>(); break;
+      case 0xA0: LDY<AM::Immediate<Core<System>>>(); break;
+      case 0xA1: LDA<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0xA2: LDX<AM::Immediate<Core<System>>>(); break;
+      case 0xA3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xA4: LDY<AM::ZeroPage<Core<System>>>(); break;
+      case 0xA5: LDA<AM::ZeroPage<Core<System>>>(); break;
+      case 0xA6: LDX<AM::ZeroPage<Core<System>>>(); break;
+      case 0xA7: SMB<AM::ZeroPage<Core<System>>,2>(); break;
+      case 0xA8: TAY(); break;
+      case 0xA9: LDA<AM::Immediate<Core<System>>>(); break;
+      case 0xAA: TAX(); break;
+      case 0xAB: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xAC: LDY<AM::Absolute<Core<System>>>(); break;
+      case 0xAD: LDA<AM::Absolute<Core<System>>>(); break;
+      case 0xAE: LDX<AM::Absolute<Core<System>>>(); break;
+      case 0xAF: BBS<AM::RelativeBitBranch<Core<System>>,2>(); break;
+      case 0xB0: Branch<AM::Relative<Core<System>>,P_C,P_C>(); break;
+      case 0xB1: LDA<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0xB2: LDA<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0xB3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xB4: LDY<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xB5: LDA<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xB6: LDX<AM::ZeroPageY<Core<System>>>(); break;
+      case 0xB7: SMB<AM::ZeroPage<Core<System>>,3>(); break;
+      case 0xB8: CLV(); break;
+      case 0xB9: LDA<AM::AbsoluteY<Core<System>>>(); break;
+      case 0xBA: TSX(); break;
+      case 0xBB: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xBC: LDY<AM::AbsoluteX<Core<System>>>(); break;
+      case 0xBD: LDA<AM::AbsoluteX<Core<System>>>(); break;
+      case 0xBE: LDX<AM::AbsoluteY<Core<System>>>(); break;
+      case 0xBF: BBS<AM::RelativeBitBranch<Core<System>>,3>(); break;
+      case 0xC0: CPY<AM::Immediate<Core<System>>>(); break;
+      case 0xC1: CMP<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0xC2: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0xC3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xC4: CPY<AM::ZeroPage<Core<System>>>(); break;
+      case 0xC5: CMP<AM::ZeroPage<Core<System>>>(); break;
+      case 0xC6: DEC<AM::ZeroPage<Core<System>>>(); break;
+      case 0xC7: SMB<AM::ZeroPage<Core<System>>,4>(); break;
+      case 0xC8: INC<AM::ImpliedY<Core<System>>>(); break;
+      case 0xC9: CMP<AM::Immediate<Core<System>>>(); break;
+      case 0xCA: DEC<AM::ImpliedX<Core<System>>>(); break;
+      case 0xCB: WAI(); break;
+      case 0xCC: CPY<AM::Absolute<Core<System>>>(); break;
+      case 0xCD: CMP<AM::Absolute<Core<System>>>(); break;
+      case 0xCE: DEC<AM::Absolute<Core<System>>>(); break;
+      case 0xCF: BBS<AM::RelativeBitBranch<Core<System>>,4>(); break;
+      case 0xD0: Branch<AM::Relative<Core<System>>,P_Z,0>(); break;
+      case 0xD1: CMP<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0xD2: CMP<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0xD3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xD4: NOP<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xD5: CMP<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xD6: DEC<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xD7: SMB<AM::ZeroPage<Core<System>>,5>(); break;
+      case 0xD8: CLD(); break;
+      case 0xD9: CMP<AM::AbsoluteY<Core<System>>>(); break;
+      case 0xDA: PHX(); break;
+      case 0xDB: STP(); break;
+      case 0xDC: NOP<AM::Absolute<Core<System>>>(); break;
+      case 0xDD: CMP<AM::AbsoluteX<Core<System>>>(); break;
+      case 0xDE: DEC<AM::AbsoluteXBug<Core<System>>>(); break;
+      case 0xDF: BBS<AM::RelativeBitBranch<Core<System>>,5>(); break;
+      case 0xE0: CPX<AM::Immediate<Core<System>>>(); break;
+      case 0xE1: SBC<AM::ZeroPageXIndirect<Core<System>>>(); break;
+      case 0xE2: NOP<AM::Immediate<Core<System>>>(); break;
+      case 0xE3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xE4: CPX<AM::ZeroPage<Core<System>>>(); break;
+      case 0xE5: SBC<AM::ZeroPage<Core<System>>>(); break;
+      case 0xE6: INC<AM::ZeroPage<Core<System>>>(); break;
+      case 0xE7: SMB<AM::ZeroPage<Core<System>>,6>(); break;
+      case 0xE8: INC<AM::ImpliedX<Core<System>>>(); break;
+      case 0xE9: SBC<AM::Immediate<Core<System>>>(); break;
+      case 0xEA: NOP<AM::Implied<Core<System>>>(); break;
+      case 0xEB: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xEC: CPX<AM::Absolute<Core<System>>>(); break;
+      case 0xED: SBC<AM::Absolute<Core<System>>>(); break;
+      case 0xEE: INC<AM::Absolute<Core<System>>>(); break;
+      case 0xEF: BBS<AM::RelativeBitBranch<Core<System>>,6>(); break;
+      case 0xF0: Branch<AM::Relative<Core<System>>,P_Z,P_Z>(); break;
+      case 0xF1: SBC<AM::ZeroPageIndirectY<Core<System>>>(); break;
+      case 0xF2: SBC<AM::ZeroPageIndirect<Core<System>>>(); break;
+      case 0xF3: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xF4: NOP<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xF5: SBC<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xF6: INC<AM::ZeroPageX<Core<System>>>(); break;
+      case 0xF7: SMB<AM::ZeroPage<Core<System>>,7>(); break;
+      case 0xF8: SED(); break;
+      case 0xF9: SBC<AM::AbsoluteY<Core<System>>>(); break;
+      case 0xFA: PLX(); break;
+      case 0xFB: NOP<AM::SuperImplied<Core<System>>>(); break;
+      case 0xFC: NOP<AM::Absolute<Core<System>>>(); break;
+      case 0xFD: SBC<AM::AbsoluteX<Core<System>>>(); break;
+      case 0xFE: INC<AM::AbsoluteXBug<Core<System>>>(); break;
+      case 0xFF: BBS<AM::RelativeBitBranch<Core<System>>,7>(); break;
+      }
+    }
     void push(uint8_t value) {
       system.write_byte(0x100 | s, value, WriteType::PUSH);
       --s;
@@ -1304,6 +1311,19 @@ namespace W65C02 {
     bool is_stopped() {
       return state == State::STOPPED;
     }
+    // Passes every bit of register and pin state through `ar`, which is
+    // called with a (possibly modified) lvalue for each field. Used by save
+    // states.
+    template<class Archive> void transfer_state(Archive& ar) {
+      uint8_t pins = irq | (irq_edge << 1) | (nmi << 2) | (nmi_edge << 3)
+        | (nmi_pending << 4) | (so << 5) | (so_edge << 6);
+      uint8_t st = static_cast<uint8_t>(state);
+      ar(a); ar(x); ar(y); ar(p); ar(s); ar(pc); ar(pins); ar(st);
+      irq = pins; irq_edge = pins >> 1; nmi = pins >> 2; nmi_edge = pins >> 3;
+      nmi_pending = pins >> 4; so = pins >> 5; so_edge = pins >> 6;
+      state = st <= static_cast<uint8_t>(State::STOPPED)
+        ? static_cast<State>(st) : State::INVALID_STATE;
+    }
   };
 }
 
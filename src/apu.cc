@@ -1,5 +1,7 @@
 #include "ars-emu.hh"
 #include "apu.hh"
+#include "audio_capture.hh"
+#include "cpu.hh"
 #include "et209.hh"
 #include "prefs.hh"
 #include "config.hh"
@@ -12,6 +14,7 @@
 #include <array>
 #include <atomic>
 #include <deque>
+#include <vector>
 
 namespace {
 #if !NO_DEBUG_CORES
@@ -115,7 +118,9 @@ namespace {
     virtual ~Mixer() {}
     virtual void operator()(const float* in, float* out) = 0;
   };
-  int target_min_queue_depth, target_max_queue_depth;
+  // written by the audio callback when adaptive_queue_depth is on, so they
+  // are atomic
+  std::atomic<int> target_min_queue_depth, target_max_queue_depth;
   float hysteresis_accum;
   int hysteresis_count;
   float target_in_rate, cur_in_rate;
@@ -133,6 +138,10 @@ namespace {
     std::atomic<unsigned int> current_element_in;
     std::atomic<unsigned int> next_element_out;
     unsigned int index_within_element = 0;
+    // how many of the elements may actually be used; lowering this bounds
+    // the latency the queue can build up
+    std::atomic<unsigned int> capacity{ELEMENT_COUNT};
+    std::atomic<uint32_t> overrun_count{0};
   public:
     AudioQueue() : current_element_in(0), next_element_out(0) {
       for(auto& array : elements) {
@@ -145,6 +154,18 @@ namespace {
       next_element_out = 0;
       index_within_element = 0;
     }
+    //// Call from ANY THREAD ////
+    void SetCapacity(unsigned int new_capacity) {
+      if(new_capacity < 3) new_capacity = 3;
+      else if(new_capacity > ELEMENT_COUNT) new_capacity = ELEMENT_COUNT;
+      capacity.store(new_capacity, std::memory_order_relaxed);
+    }
+    unsigned int GetCapacity() const {
+      return capacity.load(std::memory_order_relaxed);
+    }
+    uint32_t GetOverrunCount() const {
+      return overrun_count.load(std::memory_order_relaxed);
+    }
     //// Call from PRODUCING THREAD ////
     // Samples, not frames!!
     void AddSamplesToQueue(const float* src, unsigned int sample_count) {
@@ -164,12 +185,13 @@ namespace {
              src, samples_to_add * sizeof(float));
       assert(samples_to_add <= remaining_space_in_element);
       if(samples_to_add == remaining_space_in_element) {
-        unsigned int check_element_in
-          = (current_element_in + 2) % ELEMENT_COUNT;
         unsigned int next_element_out
           = std::atomic_load_explicit(&this->next_element_out,
                                       std::memory_order_relaxed);
-        if(check_element_in == next_element_out) {
+        unsigned int depth = (current_element_in + ELEMENT_COUNT
+                              - next_element_out) % ELEMENT_COUNT;
+        if(depth + 2 >= GetCapacity()) {
+          overrun_count.fetch_add(1, std::memory_order_relaxed);
 #if !NO_DEBUG_CORES
           if(ARS::debugging_audio)
             std::cerr << SDL_GetTicks() << ": audio queue overrun!\n";
@@ -322,11 +344,13 @@ namespace {
   float prev_frame[4] = {0.f, 0.f, 0.f, 0.f};
   SDL_AudioDeviceID dev = 0;
   SDL_AudioSpec audiospec;
+  unsigned int audio_decimation = 1, decimation_counter = 0;
   // configuration options
   int desired_sound_type;
   float virtual_speaker_separation;
   int head_width_in_samples, desired_sdl_buffer_length, resample_quality,
     desired_sample_rate, audio_sync_type;
+  bool adaptive_queue_depth;
   // dependent on configuration
   int active_sound_type;
   const Config::Element audio_elements[] = {
@@ -334,10 +358,10 @@ namespace {
     {"desired_sdl_buffer_length", desired_sdl_buffer_length},
     {"virtual_speaker_separation", virtual_speaker_separation},
     {"head_width_in_samples", head_width_in_samples},
-    // don't expose this right now, since it doesn't do anything
-    //{"resample_quality", resample_quality},
+    {"resample_quality", resample_quality},
     {"desired_sample_rate", desired_sample_rate},
     {"audio_sync_type", audio_sync_type},
+    {"adaptive_queue_depth", adaptive_queue_depth},
   };
   class AudioPrefsLogic : public PrefsLogic {
   protected:
@@ -377,75 +401,263 @@ namespace {
       desired_sample_rate = 48000;
       resample_quality = 0; // NN when close, better otherwise
       audio_sync_type = SYNC_DYNAMIC;
+      adaptive_queue_depth = true;
     }
   } audioPrefsLogic;
   // ET209 output: Center, Right, Left, Boost
-  void get_frame(float* out_frame) {
-    int16_t raw_frame[4];
-    float floppy_frame = 0.0f;
-    ARS::apu.output_frame(raw_frame);
-    for(auto&& drive : floppy_drive_sounders) {
-      if(drive.is_active()) {
-        floppy_frame += drive.get_next_sample();
+  // raw_frames has four samples per frame, out_frames has CHANNELS
+  template<int CHANNELS>
+  void get_frames(const int16_t* raw_frames, const float* floppy_frames,
+                  float* out_frames, size_t count) {
+    for(size_t n = 0; n < count; ++n) {
+      const int16_t* raw_frame = raw_frames + n * 4;
+      float* out_frame = out_frames + n * CHANNELS;
+      // floppy_frame will be added to the center channel after the filter
+      float floppy_frame = floppy_frames[n];
+      switch(CHANNELS) {
+      case 1:
+        // preserve volumes
+        out_frame[0] = (raw_frame[0]+raw_frame[1]+raw_frame[2]+2*raw_frame[3])
+          * ET209_OUTPUT_TO_FLOAT_SAMPLE * 0.5f;
+        prev_frame[0] = out_frame[0]
+          += (prev_frame[0] - out_frame[0]) * DAC_FILTER_COEFFICIENT;
+        out_frame[0] += floppy_frame;
+        break;
+      case 2:
+        // do exactly what a "real" ARS would do
+        out_frame[0] = (raw_frame[2]+(raw_frame[0]>>1)+raw_frame[3])
+          * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        out_frame[1] = (raw_frame[1]+(raw_frame[0]>>1)+raw_frame[3])
+          * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        prev_frame[0] = out_frame[0]
+          += (prev_frame[0] - out_frame[0]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[1] = out_frame[1]
+          += (prev_frame[1] - out_frame[1]) * DAC_FILTER_COEFFICIENT;
+        out_frame[0] += floppy_frame;
+        out_frame[1] += floppy_frame;
+        break;
+      case 3:
+        // let's start rearranging things with tweezers now
+        out_frame[0] = raw_frame[2] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        out_frame[1] = raw_frame[1] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        out_frame[2] = ((raw_frame[0]>>1) + raw_frame[3])
+          * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        prev_frame[0] = out_frame[0]
+          += (prev_frame[0] - out_frame[0]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[1] = out_frame[1]
+          += (prev_frame[1] - out_frame[1]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[2] = out_frame[2]
+          += (prev_frame[2] - out_frame[2]) * DAC_FILTER_COEFFICIENT;
+        out_frame[2] += floppy_frame;
+        break;
+      case 4:
+        // the onion has blossomed
+        out_frame[0] = raw_frame[2] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        out_frame[1] = raw_frame[1] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        out_frame[2] = ((raw_frame[0]>>1) + raw_frame[3])
+          * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        // TODO: Selectable LFE ratios
+        out_frame[3] = raw_frame[3] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
+        prev_frame[0] = out_frame[0]
+          += (prev_frame[0] - out_frame[0]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[1] = out_frame[1]
+          += (prev_frame[1] - out_frame[1]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[2] = out_frame[2]
+          += (prev_frame[2] - out_frame[2]) * DAC_FILTER_COEFFICIENT;
+        prev_frame[3] = out_frame[3]
+          += (prev_frame[3] - out_frame[3]) * LFE_FILTER_COEFFICIENT;
+        out_frame[2] += floppy_frame;
+        break;
       }
     }
-    // floppy_frame will be added to the center channel after the filter
+  }
+  // the APU the audio device plays, for the callbacks that run it themselves
+  ARS::APUState* device_apu = nullptr;
+  void hash_bytes(const void* p, size_t len) {
+    auto bytes = reinterpret_cast<const uint8_t*>(p);
+    uint64_t hash = ARS::apu_state->hash;
+    for(size_t n = 0; n < len; ++n)
+      hash = (hash ^ bytes[n]) * 0x100000001b3;
+    ARS::apu_state->hash = hash;
+  }
+  // enough frames to fill one AudioQueue element, even in mono
+  constexpr size_t MAX_BLOCK = AudioQueue::ELEMENT_SIZE;
+  // runs the current APU for `count` (<= MAX_BLOCK) samples, and converts
+  // them into out_frames (unless it's nullptr); the floppy sounds and
+  // AudioCapture only belong to the primary machine
+  void synthesize_frames(float* out_frames, size_t count, bool primary) {
+    int16_t raw_frames[MAX_BLOCK * 4] = {};
+    float floppy_frames[MAX_BLOCK] = {};
+    ARS::apu_state->chip.output_block(raw_frames, count);
+    for(size_t n = 0; n < count; ++n) {
+      floppy_frames[n] = 0.0f;
+      if(!primary) continue;
+      for(auto&& drive : floppy_drive_sounders) {
+        if(drive.is_active()) {
+          floppy_frames[n] += drive.get_next_sample();
+        }
+      }
+    }
+    if(primary) ARS::AudioCapture::push(raw_frames, floppy_frames, count);
+    if(ARS::apu_state->hashing) {
+      hash_bytes(raw_frames, count * 4 * sizeof(*raw_frames));
+      hash_bytes(floppy_frames, count * sizeof(*floppy_frames));
+    }
+    if(out_frames == nullptr) return;
     switch(REQUIRED_SOURCE_CHANNELS[active_sound_type]) {
-    case 1:
-      // preserve volumes
-      out_frame[0] = (raw_frame[0]+raw_frame[1]+raw_frame[2]+2*raw_frame[3])
-        * ET209_OUTPUT_TO_FLOAT_SAMPLE * 0.5f;
-      prev_frame[0] =
-        out_frame[0] += (prev_frame[0] - out_frame[0]) *DAC_FILTER_COEFFICIENT;
-      out_frame[0] += floppy_frame;
-      break;
-    case 2:
-      // do exactly what a "real" ARS would do
-      out_frame[0] = (raw_frame[2]+(raw_frame[0]>>1)+raw_frame[3])
-        * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      out_frame[1] = (raw_frame[1]+(raw_frame[0]>>1)+raw_frame[3])
-        * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      prev_frame[0] =
-        out_frame[0] += (prev_frame[0] - out_frame[0]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[1] =
-        out_frame[1] += (prev_frame[1] - out_frame[1]) *DAC_FILTER_COEFFICIENT;
-      out_frame[0] += floppy_frame;
-      out_frame[1] += floppy_frame;
-      break;
-    case 3:
-      // let's start rearranging things with tweezers now
-      out_frame[0] = raw_frame[2] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      out_frame[1] = raw_frame[1] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      out_frame[2] = ((raw_frame[0]>>1) + raw_frame[3])
-        * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      prev_frame[0] =
-        out_frame[0] += (prev_frame[0] - out_frame[0]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[1] =
-        out_frame[1] += (prev_frame[1] - out_frame[1]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[2] =
-        out_frame[2] += (prev_frame[2] - out_frame[2]) *DAC_FILTER_COEFFICIENT;
-      out_frame[2] += floppy_frame;
-      break;
-    case 4:
-      // the onion has blossomed
-      out_frame[0] = raw_frame[2] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      out_frame[1] = raw_frame[1] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      out_frame[2] = ((raw_frame[0]>>1) + raw_frame[3])
-        * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      // TODO: Selectable LFE ratios
-      out_frame[3] = raw_frame[3] * ET209_OUTPUT_TO_FLOAT_SAMPLE;
-      prev_frame[0] =
-        out_frame[0] += (prev_frame[0] - out_frame[0]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[1] =
-        out_frame[1] += (prev_frame[1] - out_frame[1]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[2] =
-        out_frame[2] += (prev_frame[2] - out_frame[2]) *DAC_FILTER_COEFFICIENT;
-      prev_frame[3] =
-        out_frame[3] += (prev_frame[3] - out_frame[3]) *LFE_FILTER_COEFFICIENT;
-      out_frame[2] += floppy_frame;
-      break;
+    case 1: get_frames<1>(raw_frames, floppy_frames, out_frames, count); break;
+    case 2: get_frames<2>(raw_frames, floppy_frames, out_frames, count); break;
+    case 3: get_frames<3>(raw_frames, floppy_frames, out_frames, count); break;
+    case 4: get_frames<4>(raw_frames, floppy_frames, out_frames, count); break;
+    }
+  }
+  // synthesizes, converts, and queues `count` samples; if `queue` is false,
+  // only synthesizes them (for AudioCapture's or hashing's sake)
+  void generate_samples(size_t count, bool queue, bool primary) {
+    float out_frames[MAX_BLOCK * 4];
+    const int SRCC = REQUIRED_SOURCE_CHANNELS[active_sound_type];
+    while(count > 0) {
+      size_t block = std::min(count, MAX_BLOCK);
+      count -= block;
+      synthesize_frames(queue ? out_frames : nullptr, block, primary);
+      if(!queue) continue;
+      size_t kept = block;
+      if(audio_decimation > 1) {
+        kept = 0;
+        for(size_t n = 0; n < block; ++n) {
+          if(++decimation_counter < audio_decimation) continue;
+          decimation_counter = 0;
+          std::copy(out_frames + n * SRCC, out_frames + (n+1) * SRCC,
+                    out_frames + kept * SRCC);
+          ++kept;
+        }
+      }
+      audio_queue->AddSamplesToQueue(out_frames, kept * SRCC);
+    }
+    if(queue && autopaused
+       && audio_queue->AvailableNumberOfElements() > target_min_queue_depth) {
+      autopaused = false;
+      SDL_PauseAudioDevice(dev, 0);
     }
   }
+  // Always-on telemetry, collected by the audio callback (except overruns,
+  // which the AudioQueue counts itself) and reported by show_audio_stats.
+  constexpr int LATENCY_BUCKETS = 250; // 1ms each, the last one is "or more"
+  struct AudioStats {
+    std::atomic<uint32_t> callbacks, underruns;
+    // queue depth (in elements) at the start of each callback
+    std::atomic<uint32_t> depth_histogram[AudioQueue::ELEMENT_COUNT];
+    // how long, in ms, the newest queued sample will take to be heard
+    std::atomic<uint32_t> latency_histogram[LATENCY_BUCKETS];
+    // longest time between two callbacks, in microseconds
+    std::atomic<uint32_t> worst_interval;
+    void reset() {
+      callbacks = 0;
+      underruns = 0;
+      for(auto& x : depth_histogram) x = 0;
+      for(auto& x : latency_histogram) x = 0;
+      worst_interval = 0;
+    }
+  } stats;
+  // Adaptive queue depth: start from the conservative targets init_apu picks,
+  // and walk them down while the callback keeps finding data to spare, back
+  // up as soon as it doesn't. Never go below what the worst recent callback
+  // interval (plus a frame's worth of bursty production) calls for.
+  constexpr int SAMPLES_PER_FRAME = 800;
+  // how many clean windows in a row before we try a shallower queue
+  constexpr int CLEAN_WINDOWS_TO_SHRINK = 3;
+  Uint64 last_callback_time;
+  int window_callbacks, window_min_depth, clean_windows;
+  bool window_underrun;
+  Uint64 window_worst_interval;
+  int elements_for_frames(int frames) {
+    return (frames * REQUIRED_SOURCE_CHANNELS[active_sound_type]
+            + AudioQueue::ELEMENT_SIZE - 1) / AudioQueue::ELEMENT_SIZE;
+  }
+  void reset_queue_adaptation() {
+    last_callback_time = 0;
+    window_callbacks = 0;
+    window_min_depth = AudioQueue::ELEMENT_COUNT;
+    window_underrun = false;
+    window_worst_interval = 0;
+    clean_windows = 0;
+  }
+  void adapt_queue_depth() {
+    int callback_elements = elements_for_frames(audiospec.samples);
+    int interval_frames = static_cast<int>
+      (window_worst_interval * audiospec.freq
+       / SDL_GetPerformanceFrequency());
+    int floor = 1 + elements_for_frames(interval_frames + SAMPLES_PER_FRAME);
+    int spread = elements_for_frames(SAMPLES_PER_FRAME * 2);
+    int new_min = target_min_queue_depth;
+    if(window_underrun) {
+      new_min += callback_elements;
+      clean_windows = 0;
+    }
+    else if(window_min_depth - callback_elements >= 1) {
+      if(++clean_windows >= CLEAN_WINDOWS_TO_SHRINK) {
+        --new_min;
+        clean_windows = 0;
+      }
+    }
+    else clean_windows = 0;
+    if(new_min < floor) new_min = floor;
+    int headroom = elements_for_frames(SAMPLES_PER_FRAME) + 2;
+    if(new_min + spread + headroom > static_cast<int>(AudioQueue::ELEMENT_COUNT))
+      new_min = AudioQueue::ELEMENT_COUNT - spread - headroom;
+#if !NO_DEBUG_CORES
+    if(ARS::debugging_audio && new_min != target_min_queue_depth)
+      std::cerr << SDL_GetTicks() << ": queue depth target now "
+                << new_min << "-" << (new_min + spread) << "\n";
+#endif
+    target_min_queue_depth = new_min;
+    target_max_queue_depth = new_min + spread;
+    audio_queue->SetCapacity(new_min + spread + headroom);
+  }
+  // call at the end of every callback that drains the queue, with the depth
+  // the queue had at the start
+  void record_callback(int depth, bool bumped) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 interval = last_callback_time ? now - last_callback_time : 0;
+    last_callback_time = now;
+    ++stats.callbacks;
+    if(bumped) ++stats.underruns;
+    ++stats.depth_histogram[std::min<int>(depth,
+                                          AudioQueue::ELEMENT_COUNT - 1)];
+    int queued_frames = depth * AudioQueue::ELEMENT_SIZE
+      / REQUIRED_SOURCE_CHANNELS[active_sound_type];
+    int latency = static_cast<int>
+      (queued_frames * 1000 / SAMPLE_RATE
+       + audiospec.samples * 1000 / audiospec.freq);
+    ++stats.latency_histogram[std::min(latency, LATENCY_BUCKETS - 1)];
+    uint32_t interval_us = static_cast<uint32_t>
+      (interval * 1000000 / SDL_GetPerformanceFrequency());
+    if(interval_us > stats.worst_interval) stats.worst_interval = interval_us;
+    if(!adaptive_queue_depth || audio_sync_type != SYNC_DYNAMIC) return;
+    window_worst_interval = std::max(window_worst_interval, interval);
+    window_min_depth = std::min(window_min_depth, depth);
+    window_underrun = window_underrun || bumped;
+    // about a second's worth of callbacks
+    if(++window_callbacks >= audiospec.freq / audiospec.samples) {
+      adapt_queue_depth();
+      window_callbacks = 0;
+      window_min_depth = AudioQueue::ELEMENT_COUNT;
+      window_underrun = false;
+      window_worst_interval = 0;
+    }
+  }
+  // the smallest latency bucket at or below which `fraction` of all
+  // callbacks fell
+  int latency_percentile(float fraction) {
+    uint32_t total = 0;
+    for(auto& x : stats.latency_histogram) total += x;
+    uint32_t seen = 0;
+    for(int n = 0; n < LATENCY_BUCKETS; ++n) {
+      seen += stats.latency_histogram[n];
+      if(seen > 0 && seen >= total * fraction) return n;
+    }
+    return 0;
+  }
   int mix_out(const float* inp, float* outp, size_t amount_to_out) {
     const int SRCC = REQUIRED_SOURCE_CHANNELS[active_sound_type];
     const int DSTC = audiospec.channels;
@@ -465,6 +677,7 @@ namespace {
       * REQUIRED_SOURCE_CHANNELS[active_sound_type] / audiospec.channels;
     bool bumped = false;
     int effective_depth = audio_queue->AvailableNumberOfElements();
+    int starting_depth = effective_depth;
     if(cur_in_rate < 0) {
       target_in_rate = SAMPLE_RATE;
     }
@@ -535,6 +748,7 @@ namespace {
         rem -= rem_in_cvt;
       }
     }
+    record_callback(starting_depth, bumped);
     if(bumped) {
 #if !NO_DEBUG_CORES
       if(ARS::debugging_audio)
@@ -550,6 +764,7 @@ namespace {
     int rem = (bytes / sizeof(float))
       * REQUIRED_SOURCE_CHANNELS[active_sound_type] / audiospec.channels;
     bool bumped = false;
+    int starting_depth = audio_queue->AvailableNumberOfElements();
     if(!cur_cvt) {
       cur_cvt = MakeAudioCvt(resample_quality,
                              SAMPLE_RATE,
@@ -571,6 +786,7 @@ namespace {
         rem -= rem_in_cvt;
       }
     }
+    record_callback(starting_depth, bumped);
     if(bumped) {
 #if !NO_DEBUG_CORES
       if(ARS::debugging_audio)
@@ -581,6 +797,7 @@ namespace {
     }
   }
   void make_and_convert_lots_of_samples(void*, Uint8* _stream, int bytes) {
+    ARS::apu_state = device_apu;
     if(!cur_cvt) {
       cur_cvt = MakeAudioCvt(resample_quality,
                              SAMPLE_RATE,
@@ -596,12 +813,7 @@ namespace {
       auto rem_in_cvt = cur_cvt->GetNumberOfSamplesRemaining();
       if(rem_in_cvt == 0) {
         float buf[AudioQueue::ELEMENT_SIZE];
-        float* localp = buf;
-        int localrem = AudioQueue::ELEMENT_SIZE / SRCC;
-        while(localrem-- > 0) {
-          get_frame(localp);
-          localp += SRCC;
-        }
+        synthesize_frames(buf, AudioQueue::ELEMENT_SIZE / SRCC, true);
         cur_cvt->ConvertMore(buf);
       }
       else {
@@ -615,14 +827,19 @@ namespace {
     }
   }
   void make_lots_of_samples(void*, Uint8* _stream, int bytes) {
-    float raw_frame[4];
+    ARS::apu_state = device_apu;
+    float frames[MAX_BLOCK * 4];
+    const int SRCC = REQUIRED_SOURCE_CHANNELS[active_sound_type];
     float* outp = reinterpret_cast<float*>(_stream);
-    int rem = bytes / sizeof(float);
+    size_t rem = bytes / sizeof(float) / audiospec.channels;
     while(rem > 0) {
-      get_frame(raw_frame);
-      (*mixer)(raw_frame, outp);
-      outp += audiospec.channels;
-      rem -= audiospec.channels;
+      size_t block = std::min(rem, MAX_BLOCK);
+      rem -= block;
+      synthesize_frames(frames, block, true);
+      for(size_t n = 0; n < block; ++n) {
+        (*mixer)(frames + n * SRCC, outp);
+        outp += audiospec.channels;
+      }
     }
   }
 #if !NO_DEBUG_CORES
@@ -745,10 +962,11 @@ namespace {
   };
 }
 
-ET209 ARS::apu;
+__thread ARS::APUState* ARS::apu_state;
 
 void ARS::init_apu() {
   if(dev != 0) SDL_CloseAudioDevice(dev);
+  device_apu = apu_state;
   active_sound_type = desired_sound_type;
   do {
     SDL_AudioSpec desired;
@@ -846,7 +1064,7 @@ void ARS::init_apu() {
       / AudioQueue::ELEMENT_SIZE
       // at least one frame
       + AudioQueue::APPROX_ELEMENTS_PER_FRAME;
-    target_min_queue_depth *= audiospec.channels;
+    target_min_queue_depth = target_min_queue_depth * audiospec.channels;
     target_max_queue_depth
       = AudioQueue::ELEMENT_COUNT-2;
     break;
@@ -862,7 +1080,7 @@ void ARS::init_apu() {
       / AudioQueue::ELEMENT_SIZE
       // at least one frame
       + AudioQueue::APPROX_ELEMENTS_PER_FRAME;
-    target_min_queue_depth *= audiospec.channels;
+    target_min_queue_depth = target_min_queue_depth * audiospec.channels;
     target_max_queue_depth =
       std::min((
       // bare minimum
@@ -876,6 +1094,9 @@ void ARS::init_apu() {
       AudioQueue::ELEMENT_COUNT - 2);
     break;
   }
+  if(audio_queue) audio_queue->SetCapacity(AudioQueue::ELEMENT_COUNT);
+  stats.reset();
+  reset_queue_adaptation();
 #if !NO_DEBUG_CORES
   if(audio_sync_type == SYNC_NONE) {
     if(debugwindow != nullptr) {
@@ -929,6 +1150,13 @@ void ARS::init_apu() {
     }
 #endif
   }
+  // the callback makes its converters, but shouldn't have to build filters
+  if(audio_sync_type == SYNC_DYNAMIC)
+    PrepareAudioCvt(resample_quality, MINIMUM_PERMITTED_SAMPLE_RATE,
+                    MAXIMUM_PERMITTED_SAMPLE_RATE, audiospec.freq);
+  else
+    PrepareAudioCvt(resample_quality, SAMPLE_RATE, SAMPLE_RATE,
+                    audiospec.freq);
   if(audio_sync_type == SYNC_NONE) {
     autopaused = false;
     SDL_PauseAudioDevice(dev, 0);
@@ -936,16 +1164,97 @@ void ARS::init_apu() {
   else autopaused = true;
 }
 
-void ARS::output_apu_sample() {
-  if(dev <= 0 || audio_sync_type == SYNC_NONE) return;
-  float samples[4];
-  get_frame(samples);
-  audio_queue->AddSamplesToQueue(samples, REQUIRED_SOURCE_CHANNELS[active_sound_type]);
-  if(autopaused
-     && audio_queue->AvailableNumberOfElements() > target_min_queue_depth) {
-    autopaused = false;
-    SDL_PauseAudioDevice(dev, 0);
+void ARS::write_apu(uint8_t addr, uint8_t value) {
+  apu_state->pending_writes.push_back({board->cpu->cyclesIntoRun(), addr,
+                                      value});
+}
+
+void ARS::run_apu(uint32_t& audio_cycle_counter, int count) {
+  // sample n of this run comes due this many cycles into it
+  int first_sample_cycle = 256 - audio_cycle_counter;
+  audio_cycle_counter += count;
+  size_t sample_count = audio_cycle_counter / 256;
+  audio_cycle_counter %= 256;
+  auto& chip = apu_state->chip;
+  auto& pending_writes = apu_state->pending_writes;
+  auto next_write = pending_writes.cbegin();
+  // only the primary machine is heard
+  bool primary = board->primary;
+  bool queue = primary && dev > 0 && audio_sync_type != SYNC_NONE;
+  // (with a device and no sync, the audio callback runs the APU itself)
+  bool callback_runs_apu = primary && dev > 0 && audio_sync_type == SYNC_NONE;
+  if(queue || (!callback_runs_apu
+               && ((primary && AudioCapture::isActive())
+                   || apu_state->hashing))) {
+    size_t samples_done = 0;
+    while(samples_done < sample_count) {
+      int sample_cycle = first_sample_cycle + samples_done * 256;
+      while(next_write != pending_writes.cend()
+            && next_write->cycle < sample_cycle) {
+        chip.write(next_write->addr, next_write->value);
+        ++next_write;
+      }
+      // synthesize up to (and including) the last sample before the next
+      // write, all at once
+      size_t samples_to_do = sample_count - samples_done;
+      if(next_write != pending_writes.cend()) {
+        samples_to_do
+          = std::min<size_t>(samples_to_do,
+                             (next_write->cycle - first_sample_cycle) / 256
+                             + 1 - samples_done);
+      }
+      generate_samples(samples_to_do, queue, primary);
+      samples_done += samples_to_do;
+    }
+  }
+  while(next_write != pending_writes.cend()) {
+    chip.write(next_write->addr, next_write->value);
+    ++next_write;
+  }
+  pending_writes.clear();
+}
+
+void ARS::set_audio_hashing(bool enabled) {
+  apu_state->hashing = enabled;
+}
+
+uint64_t ARS::get_audio_hash() {
+  return apu_state->hash;
+}
+
+void ARS::show_audio_stats() {
+  if(dev <= 0 || audio_sync_type == SYNC_NONE || !audio_queue) {
+    ui << sn.Get("AUDIO_STATS_UNAVAILABLE"_Key) << ui;
+    return;
+  }
+  std::string underruns = TEG::format("%u", stats.underruns.load());
+  std::string overruns = TEG::format("%u", audio_queue->GetOverrunCount());
+  std::string typical = TEG::format("%i", latency_percentile(0.5f));
+  std::string worst = TEG::format("%i", latency_percentile(0.99f));
+  ui << sn.Get("AUDIO_STATS_SUMMARY"_Key,
+               {underruns, overruns, typical, worst}) << ui;
+  sn.Out(std::cout, "AUDIO_STATS_DUMP"_Key,
+         {TEG::format("%u", stats.callbacks.load()),
+             underruns, overruns, typical, worst,
+             TEG::format("%i", audiospec.samples * 1000 / audiospec.freq),
+             TEG::format("%.1f", stats.worst_interval / 1000.0),
+             TEG::format("%i-%i", (int)target_min_queue_depth,
+                         (int)target_max_queue_depth),
+             TEG::format("%u", audio_queue->GetCapacity())});
+  for(unsigned int n = 0; n < AudioQueue::ELEMENT_COUNT; ++n) {
+    if(stats.depth_histogram[n] != 0)
+      std::cout << "  depth " << n << ": " << stats.depth_histogram[n] << "\n";
   }
+  for(int n = 0; n < LATENCY_BUCKETS; ++n) {
+    if(stats.latency_histogram[n] != 0)
+      std::cout << "  " << n << (n == LATENCY_BUCKETS-1 ? "+" : "")
+                << "ms: " << stats.latency_histogram[n] << "\n";
+  }
+}
+
+void ARS::set_audio_decimation(unsigned int n) {
+  audio_decimation = n > 0 ? n : 1;
+  decimation_counter = 0;
 }
 
 std::shared_ptr<Menu> Menu::createAudioMenu() {
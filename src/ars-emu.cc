@@ -9,13 +9,18 @@
 #include "cpu.hh"
 #include "cartridge.hh"
 #include "controller.hh"
-#include "configurator.hh"
 #include "apu.hh"
+#include "audio_capture.hh"
+#include "frame_capture.hh"
 #include "ppu.hh"
 #include "fx.hh"
 #include "display.hh"
 #include "expansions.hh"
 #include "floppy.hh"
+#include "savestate.hh"
+#include "rewind.hh"
+#include "movie.hh"
+#include "machine.hh"
 
 #include <iostream>
 #include <iomanip>
@@ -35,19 +40,18 @@
 
 using namespace ARS;
 
-std::unique_ptr<ARS::CPU> ARS::cpu;
 typedef std::chrono::duration<int64_t, std::ratio<1,60> > frame_duration;
 bool ARS::safe_mode = false, ARS::debugging_audio = false,
   ARS::debugging_video = false;
 std::string ARS::window_title;
-uint8_t ARS::dram[0x8000];
 SN::Context sn;
 std::unique_ptr<Display> ARS::display;
-uint16_t ARS::last_known_pc;
+__thread MainBoard* ARS::board;
 
 namespace {
   unsigned int thread_count = 0;
-  uint8_t bankMap[8];
+  // the one the window, the speakers, and the controllers are connected to
+  std::unique_ptr<Machine> machine;
   std::string rom_path;
   bool rom_path_specified = false;
   std::unique_ptr<CPU>(*makeCPU)(const std::string&) = makeScanlineCPU;
@@ -58,36 +62,39 @@ namespace {
   decltype(std::chrono::high_resolution_clock::now()) epoch;
   bool window_visible = true, window_minimized = false, quit = false,
     quit_on_stop = false, stop_has_been_detected = false, need_reset = true;
+  // headless mode: no window, no audio, no pacing. 0 frames = run until STP
+  bool headless = false, headless_invisible = false;
+  int64_t headless_frame_count = 0;
+  // print a hash of every frame, for comparing renderers (or builds)
+  bool headless_frame_hashes = false;
+  // print one hash of all the frames and one of all the audio, at the end
+  bool headless_summary_hashes = false;
   PPU::raw_screen screenbuf;
+  std::vector<uint8_t> quick_state;
+  unsigned int rewind_seconds = 10;
+  // how many frames each press (or repeat) of the Rewind key goes back
+  constexpr unsigned int REWIND_STEP_FRAMES = 10;
+  bool fast_forward = false;
+  // how many frames are emulated per presented frame while fast-forwarding
+  unsigned int fast_forward_factor = 10;
+  std::string movie_record_path, movie_play_path;
   void cleanup() {
-    cartridge.reset();
+    Movie::stop();
+    AudioCapture::stop();
+    FrameCapture::stop();
+    if(machine) machine->board.cartridge.reset();
     display.reset();
     SDL_Quit();
   }
   struct EscapeException {};
-  void badread(uint16_t addr) {
-    ui << sn.Get("BAD_READ"_Key, {TEG::format("%04X",addr)}) << ui;
-  }
-  void badwrite(uint16_t addr) {
-    ui << sn.Get("BAD_WRITE"_Key, {TEG::format("%04X",addr)}) << ui;
-  }
-  void busconflict(uint16_t addr, std::string bus) {
-    ui << sn.Get("BUS_CONFLICT"_Key, {TEG::format("%04X",addr), std::move(bus)}) << ui;
+  void performReset() {
+    need_reset = false;
+    machine->reset();
+    epoch = std::chrono::high_resolution_clock::now();
+    logic_frame = -1;
   }
   void mainLoop() {
-    if(need_reset) {
-      need_reset = false;
-      cartridge->handleReset();
-      PPU::handleReset();
-      cpu->setNMI(false);
-      cpu->setIRQ(false);
-      cpu->handleReset();
-      secure_config_port_checked = false;
-      for(size_t n = 0; n < sizeof(bankMap) / sizeof(*bankMap); ++n)
-        bankMap[n] = cartridge->getPowerOnBank();
-      epoch = std::chrono::high_resolution_clock::now();
-      logic_frame = -1;
-    }
+    if(need_reset) performReset();
     ++logic_frame;
     auto now = std::chrono::high_resolution_clock::now();
     auto target_frame = std::chrono::duration_cast<frame_duration>(now - epoch)
@@ -105,21 +112,40 @@ namespace {
       ui << sn.Get("TEMPORAL_ANOMALY"_Key) << ui;
       logic_frame = target_frame;
     }
+    // Every emulated frame, however it gets run, ends with
+    // Rewind::captureFrame and Movie::endFrame; rewind history and movies
+    // both count frames, and fall out of step if any are missed.
 #ifdef EMSCRIPTEN
     while(logic_frame < target_frame) {
       ++logic_frame;
-      cartridge->oncePerFrame();
+      board->cartridge->oncePerFrame();
       PPU::renderInvisible();
+      FrameCapture::skip();
+      Rewind::captureFrame();
+      Movie::endFrame();
     }
 #endif
-    cartridge->oncePerFrame();
+    if(fast_forward) {
+      for(unsigned int n = 1; n < fast_forward_factor; ++n) {
+        board->cartridge->oncePerFrame();
+        PPU::renderInvisible();
+        FrameCapture::skip();
+        Rewind::captureFrame();
+        Movie::endFrame();
+      }
+    }
+    board->cartridge->oncePerFrame();
     if(logic_frame >= target_frame && window_visible && !window_minimized) {
       PPU::renderFrame(screenbuf);
+      FrameCapture::push(screenbuf);
       display->update(screenbuf);
     }
     else {
       PPU::renderInvisible();
+      FrameCapture::skip();
     }
+    Rewind::captureFrame();
+    Movie::endFrame();
     Windower::Update();
     if(target_frame < logic_frame) {
 #ifdef __WIN32__
@@ -146,13 +172,110 @@ namespace {
         break;
       }
     }
-    if(!stop_has_been_detected && cpu->isStopped()) {
+    if(!stop_has_been_detected && board->cpu->isStopped()) {
       ui << sn.Get("CPU_STOPPED"_Key) << ui;
       stop_has_been_detected = true;
       if(quit_on_stop)
         quit = true;
     }
   }
+  // FNV-1a
+  uint64_t hashFrame(const PPU::raw_screen& screen) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for(auto& row : screen) {
+      for(auto pixel : row) {
+        hash = (hash ^ pixel) * 0x100000001b3;
+      }
+    }
+    return hash;
+  }
+  // Runs frames back to back, with no pacing, no events, and no presentation,
+  // until the requested number of frames have been run or the CPU stops.
+  void headlessLoop() {
+    int64_t frames_run = 0;
+    uint64_t video_hash = 0xcbf29ce484222325;
+    if(headless_summary_hashes) set_audio_hashing(true);
+    auto start = std::chrono::high_resolution_clock::now();
+    while(!quit) {
+      try {
+        while(!quit) {
+          if(headless_frame_count > 0 && frames_run >= headless_frame_count) {
+            quit = true;
+            break;
+          }
+          if(need_reset) performReset();
+          board->cartridge->oncePerFrame();
+          if(headless_invisible) {
+            PPU::renderInvisible();
+            FrameCapture::skip();
+          }
+          else {
+            PPU::renderFrame(screenbuf);
+            FrameCapture::push(screenbuf, true);
+            if(headless_frame_hashes || headless_summary_hashes) {
+              uint64_t hash = hashFrame(screenbuf);
+              if(headless_frame_hashes)
+                sn.Out(std::cout, "HEADLESS_FRAME_HASH"_Key,
+                       {TEG::format("%lli", (long long)frames_run),
+                        TEG::format("%016llx", (unsigned long long)hash)});
+              for(int n = 0; n < 64; n += 8)
+                video_hash = (video_hash ^ ((hash >> n) & 255))
+                  * 0x100000001b3;
+            }
+          }
+          ++frames_run;
+          Movie::endFrame();
+          if(Movie::hasEnded()) quit = true;
+          if(board->cpu->isStopped()) {
+            stop_has_been_detected = true;
+            quit = true;
+          }
+        }
+      }
+      catch(const EscapeException& e) {
+      }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>
+      (std::chrono::high_resolution_clock::now() - start).count();
+    double fps = elapsed > 0 ? frames_run / elapsed : 0;
+    sn.Out(std::cout, stop_has_been_detected ? "HEADLESS_STOPPED"_Key
+           : "HEADLESS_FINISHED"_Key,
+           {TEG::format("%lli", (long long)frames_run),
+            TEG::format("%.3f", elapsed),
+            TEG::format("%.1f", fps)});
+    // for ars-regress, so not translated, and never to be changed lightly
+    if(headless_summary_hashes)
+      std::cout << TEG::format("ARS-REGRESS frames=%lli seconds=%.6f"
+                               " video=%016llx audio=%016llx\n",
+                               (long long)frames_run, elapsed,
+                               (unsigned long long)video_hash,
+                               (unsigned long long)get_audio_hash());
+  }
+  // resetting or going back in time would desynchronize a movie
+  bool movieForbidsTimeTravel() {
+    if(!Movie::isActive()) return false;
+    ui << sn.Get("MOVIE_FORBIDS_TIME_TRAVEL"_Key) << ui;
+    return true;
+  }
+  void quickFreeze() {
+    freezeMachine(quick_state);
+    ui << sn.Get("QUICK_FROZEN"_Key) << ui;
+  }
+  void quickDefrost() {
+    if(movieForbidsTimeTravel()) return;
+    if(quick_state.empty()) {
+      ui << sn.Get("NOTHING_TO_DEFROST"_Key) << ui;
+      return;
+    }
+    try {
+      defrostMachine(quick_state.data(), quick_state.size());
+      ui << sn.Get("QUICK_DEFROSTED"_Key) << ui;
+    }
+    catch(std::string& reason) {
+      ui << reason << ui;
+      quick_state.clear();
+    }
+  }
   void printUsage() {
     sn.Out(std::cout, "USAGE"_Key);
 #ifndef DISALLOW_FLOPPY
@@ -223,6 +346,7 @@ namespace {
               std::string nextarg = argv[n++];
               GameFolder::load_debug_symbols = false;
               if(nextarg == "fast") makeCPU = makeScanlineCPU;
+              else if(nextarg == "cached") makeCPU = makeCachedCPU;
 #ifndef NO_DEBUG_CORES
               else if(nextarg == "fast_intprof") makeCPU = makeScanlineIntProfCPU;
               else if(nextarg == "fast_debug") {
@@ -288,6 +412,89 @@ namespace {
           case 'S':
             safe_mode = true;
             break;
+          case 'H':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-H"});
+              valid = false;
+            }
+            else {
+              std::string nextarg = argv[n++];
+              headless = true;
+              headless_frame_count = std::stoll(nextarg);
+              if(headless_frame_count < 0) headless_frame_count = 0;
+            }
+            break;
+          case 'I':
+            headless_invisible = true;
+            break;
+          case 'P':
+            PPU::use_pixel_renderer = true;
+            break;
+          case 'X':
+            headless_frame_hashes = true;
+            break;
+          case 'Y':
+            headless_summary_hashes = true;
+            break;
+          case 'K':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-K"});
+              valid = false;
+            }
+            else {
+              std::string nextarg = argv[n++];
+              unsigned long l = std::stoul(nextarg);
+              if(l < 2) l = 2;
+              else if(l > 100) l = 100;
+              fast_forward_factor = l;
+            }
+            break;
+          case 'W':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-W"});
+              valid = false;
+            }
+            else {
+              std::string nextarg = argv[n++];
+              if(!AudioCapture::start(nextarg)) valid = false;
+            }
+            break;
+          case 'O':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-O"});
+              valid = false;
+            }
+            else {
+              std::string nextarg = argv[n++];
+              if(!FrameCapture::start(nextarg)) valid = false;
+            }
+            break;
+          case 'M':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-M"});
+              valid = false;
+            }
+            else movie_record_path = argv[n++];
+            break;
+          case 'm':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-m"});
+              valid = false;
+            }
+            else movie_play_path = argv[n++];
+            break;
+          case 'R':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-R"});
+              valid = false;
+            }
+            else {
+              std::string nextarg = argv[n++];
+              unsigned long l = std::stoul(nextarg);
+              if(l > 600) l = 600;
+              rewind_seconds = l;
+            }
+            break;
           default:
             sn.Out(std::cout, "UNKNOWN_OPTION"_Key, {std::string(arg-1,1)});
             valid = false;
@@ -304,7 +511,7 @@ namespace {
         rom_path_specified = true;
       }
     }
-    if(!rom_path_specified && !SDL_Init(SDL_INIT_VIDEO)) {
+    if(!rom_path_specified && !headless && !SDL_Init(SDL_INIT_VIDEO)) {
       // Did we get a drag-and-drop?
       SDL_EventState(SDL_DROPFILE, SDL_ENABLE);
       SDL_Event evt;
@@ -367,7 +574,7 @@ namespace {
                {rom_path, true_path});
         rom_path = true_path;
       }
-      ARS::cartridge = ARS::Cartridge::load(*gamefolder, port1type, port2type);
+      board->cartridge = Cartridge::load(*gamefolder, port1type, port2type);
     }
     catch(std::string& reason) {
       std::string death = sn.Get("CARTRIDGE_LOADING_FAIL"_Key, {reason});
@@ -467,26 +674,47 @@ namespace {
 void ARS::handleEmulatorButtonPress(EmulatorButton button) {
   switch(button) {
   case EMUBUTTON_RESET:
+    if(movieForbidsTimeTravel()) break;
     triggerReset();
     break;
   case EMUBUTTON_TOGGLE_BG:
-    PPU::show_background = !PPU::show_background;
-    ui << sn.Get(PPU::show_background?"BACKGROUND_SHOWN"_Key
+    PPU::state->show_background = !PPU::state->show_background;
+    ui << sn.Get(PPU::state->show_background?"BACKGROUND_SHOWN"_Key
                  :"BACKGROUND_HIDDEN"_Key) << ui;
     break;
   case EMUBUTTON_TOGGLE_SP:
-    PPU::show_sprites = !PPU::show_sprites;
-    ui << sn.Get(PPU::show_sprites?"SPRITES_SHOWN"_Key
+    PPU::state->show_sprites = !PPU::state->show_sprites;
+    ui << sn.Get(PPU::state->show_sprites?"SPRITES_SHOWN"_Key
                  :"SPRITES_HIDDEN"_Key) << ui;
     break;
   case EMUBUTTON_TOGGLE_OL:
-    PPU::show_overlay = !PPU::show_overlay;
-    ui << sn.Get(PPU::show_overlay?"OVERLAY_SHOWN"_Key
+    PPU::state->show_overlay = !PPU::state->show_overlay;
+    ui << sn.Get(PPU::state->show_overlay?"OVERLAY_SHOWN"_Key
                  :"OVERLAY_HIDDEN"_Key) << ui;
     break;
   case EMUBUTTON_SCREENSHOT:
     takeScreenshot();
     break;
+  case EMUBUTTON_FREEZE:
+    quickFreeze();
+    break;
+  case EMUBUTTON_DEFROST:
+    quickDefrost();
+    break;
+  case EMUBUTTON_FAST_FORWARD:
+    fast_forward = !fast_forward;
+    set_audio_decimation(fast_forward ? fast_forward_factor : 1);
+    ui << sn.Get(fast_forward?"FAST_FORWARD_ON"_Key
+                 :"FAST_FORWARD_OFF"_Key) << ui;
+    break;
+  case EMUBUTTON_AUDIO_STATS:
+    show_audio_stats();
+    break;
+  case EMUBUTTON_REWIND:
+    if(movieForbidsTimeTravel()) break;
+    if(!Rewind::stepBack(REWIND_STEP_FRAMES))
+      ui << sn.Get("NOTHING_TO_REWIND"_Key) << ui;
+    break;
   default:
     break;
   }
@@ -506,72 +734,24 @@ void ARS::temporalAnomaly() {
   experiencing_temporal_anomaly = true;
 }
 
-uint8_t ARS::read(uint16_t addr, bool OL, bool VPB, bool SYNC) {
-  // TODO: detect bus conflicts
-  if(SYNC) last_known_pc = addr;
-  (void)busconflict;
-  if(addr < 0x8000) {
-    if((addr & 0xFFF9) == 0x0211)
-      return PPU::complexRead(addr);
-    else if((addr & 0xFFF8) == 0x0240) {
-      if(expansions[addr&7]) return expansions[addr&7]->input();
-      else {
-        // let spurious debug port reads/writes slide
-        if(addr != 0x247) badread(addr);
-        return 0xBB;
-      }
-    }
-    else return dram[addr];
-  }
-  else return cartridge->read(bankMap[(addr>>12)-8], addr, OL, VPB, SYNC);
-  badread(addr);
-  return 0xBB;
+void ARS::freezeMainBoard(Freezer& f) {
+  f(board->dram);
+  f(board->bankMap);
+  f(board->last_known_pc);
+  f(board->secure_config_port_checked);
 }
 
-void ARS::write(uint16_t addr, uint8_t value) {
-  // TODO: detect bus conflicts
-  (void)busconflict;
-  if(addr < 0x8000) {
-    // prevent writes to SimpleConfig's working or display memory as long as
-    // the configurator is in use
-    if(allow_secure_config_port
-       && Configurator::is_protected_memory_address(addr)
-       && !Configurator::is_secure_configuration_address(last_known_pc)
-       && Configurator::is_active())
-      return;
-    dram[addr] = value;
-    if(addr >= 0x0200 && addr < 0x0250) {
-      if((addr ^ 0x0210) < 16) PPU::complexWrite(addr, value);
-      else if((addr & 0xFFE0) == 0x0220) apu.write(addr&0x1F, value);
-      else if((addr & 0xFFF0) == 0x0240) {
-        if(addr >= 0x0248) {
-          auto bs = cartridge->getBS();
-          auto startBank = (addr&7)&~(7>>bs);
-          auto stopBank = ((addr&7)|(7>>bs))+1;
-          secure_config_port_checked = false;
-          for(auto n = startBank; n < stopBank; ++n) {
-            bankMap[n] = value;
-          }
-        }
-        else {
-          if(expansions[addr&7]) expansions[addr&7]->output(value);
-          // let spurious debug port reads/writes slide
-          else if(addr != 0x247) badwrite(addr);
-        }
-      }
-    }
-    return;
-  }
-  else {
-    cartridge->write(bankMap[(addr>>12)-8], addr, value);
-    return;
-  }
-  badwrite(addr);
+void ARS::defrostMainBoard(Defroster& d) {
+  d(board->dram);
+  d(board->bankMap);
+  d(board->last_known_pc);
+  d(board->secure_config_port_checked);
+  rebuildPageTables();
 }
 
 uint8_t ARS::getBankForAddr(uint16_t addr) {
   if(addr < 0x8000) return 0; // no bank
-  else return bankMap[(addr>>12)-8];
+  else return board->bankMap[(addr>>12)-8];
 }
 
 extern "C" int teg_main(int argc, char** argv) {
@@ -579,12 +759,41 @@ extern "C" int teg_main(int argc, char** argv) {
   IO::DoRedirectOutput();
 #endif
   try {
+    // the cartridge is loaded straight into it, while parsing the command
+    // line
+    machine = std::make_unique<Machine>(true);
+    machine->makeCurrent();
     sn.AddCatSource(IO::GetSNCatSource());
     if(!sn.SetLanguage(sn.GetSystemLanguage()))
       die("Unable to load language files. Please ensure a Lang directory exists in the Data directory next to the emulator.");
     if(!parseCommandLine(argc, const_cast<const char**>(argv))) return 1;
     Font::Load();
-    srand(time(NULL)); // rand() is only used for trashing memory on reset
+    // the seed only decides the garbage memory powers on with, but a movie
+    // has to get the same garbage every time it's played, and so do hashed
+    // runs
+    uint32_t seed = headless_frame_hashes || headless_summary_hashes ? 0
+      : time(NULL);
+    if(!movie_play_path.empty()) {
+      if(!Movie::startPlayback(movie_play_path)) return 1;
+      seed = Movie::getSeed();
+    }
+    else if(!movie_record_path.empty()
+            && !Movie::startRecording(movie_record_path, seed))
+      return 1;
+    if(headless) {
+      // no window, no audio device, no controllers beyond the virtual ones
+      atexit(cleanup);
+      debugging_audio = false;
+      debugging_video = false;
+      PrefsLogic::DefaultsAll();
+      PrefsLogic::LoadAll();
+      Controller::initControllers(port1type, port2type);
+      quit = false;
+      board->cpu = makeCPU(rom_path);
+      machine->powerOn(seed);
+      headlessLoop();
+      return 0;
+    }
     if(SDL_Init(SDL_INIT_VIDEO|SDL_INIT_AUDIO|SDL_INIT_GAMECONTROLLER))
       die("%s", sn.Get("SDL_FAIL"_Key).c_str());
     SDL_EventState(SDL_DROPFILE, SDL_DISABLE);
@@ -598,9 +807,9 @@ extern "C" int teg_main(int argc, char** argv) {
       : Display::makeConfiguredDisplay();
     Controller::initControllers(port1type, port2type);
     quit = false;
-    cpu = makeCPU(rom_path);
-    fillDramWithGarbage(dram, sizeof(dram));
-    PPU::fillWithGarbage();
+    board->cpu = makeCPU(rom_path);
+    machine->powerOn(seed);
+    Rewind::setHistoryLength(rewind_seconds);
 #ifdef EMSCRIPTEN
     emscripten_set_main_loop(mainLoop, 0, 1);
 #else
@@ -0,0 +1,312 @@
+#include "teg.hh"
+#include "sn.hh"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+SN::Context sn;
+
+/* Runs each cartridge (and, optionally, movie) in a manifest through a
+   headless ars-emu, several at once, and compares the hashes of the video and
+   audio they produce against the ones recorded in the manifest.
+
+   The manifest is a text file with one run per line:
+
+   path/to/game.etarz FRAMES [movie=path/to/movie] [video=HASH] [audio=HASH]
+
+   Paths are relative to the directory containing the manifest, and can't
+   contain spaces. FRAMES of 0 runs until the movie ends, or the game executes
+   STP, and needs a movie, so that a game that never stops can't hang the
+   run. Everything after a # is a comment. Only the hashes a run has are
+   checked. A run with neither is an error, unless -u is given, in which case
+   it's reported as new; -u writes the hashes of every successful run back
+   into the manifest. */
+
+namespace {
+  struct Run {
+    // as written in the manifest
+    std::string rom_arg, movie_arg;
+    std::string rom, movie;
+    long long frames;
+    std::string golden_video, golden_audio;
+    size_t line; // index into manifest_lines
+    // results
+    bool ran = false;
+    long long frames_run;
+    double seconds;
+    std::string video, audio, error;
+  };
+  std::vector<std::string> manifest_lines;
+  std::vector<Run> runs;
+  std::atomic<size_t> next_run;
+  std::mutex progress_lock;
+  std::string manifest_path, emulator_path, extra_args;
+  unsigned int job_count = 0;
+  bool update_goldens = false;
+  void print_usage() {
+    std::cout << "Usage: ars-regress [options] manifest\n"
+      "Options:\n"
+      "-e: Path to the emulator to test (default: the ars-emu next to this"
+      " program)\n"
+      "-j: Number of emulators to run at once (default: one per core)\n"
+      "-a: Extra options to give the emulator, e.g. \"-P\"\n"
+      "-u: Write the resulting hashes into the manifest\n";
+  }
+  std::string quote(const std::string& arg) {
+#if __WIN32__
+    return "\"" + arg + "\"";
+#else
+    std::string ret = "'";
+    for(char c : arg) {
+      if(c == '\'') ret += "'\\''";
+      else ret += c;
+    }
+    return ret + "'";
+#endif
+  }
+  std::string relative_to_manifest(const std::string& path) {
+    if(path.empty() || path[0] == '/' || path[0] == '\\'
+       || (path.size() > 1 && path[1] == ':')) return path;
+    auto sep = manifest_path.find_last_of("/\\");
+    if(sep == std::string::npos) return path;
+    return manifest_path.substr(0, sep + 1) + path;
+  }
+  bool load_manifest() {
+    std::ifstream in(manifest_path);
+    if(!in) {
+      std::cerr << manifest_path << ": could not open\n";
+      return false;
+    }
+    bool valid = true;
+    std::string line;
+    while(std::getline(in, line)) {
+      manifest_lines.push_back(line);
+      auto comment = line.find('#');
+      std::istringstream fields(line.substr(0, comment));
+      Run run;
+      if(!(fields >> run.rom_arg)) continue;
+      if(!(fields >> run.frames) || run.frames < 0) {
+        std::cerr << manifest_path << ":" << manifest_lines.size()
+                  << ": missing or invalid frame count\n";
+        valid = false;
+        continue;
+      }
+      std::string field;
+      while(fields >> field) {
+        auto eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? ""
+          : field.substr(eq + 1);
+        if(key == "movie") run.movie_arg = value;
+        else if(key == "video") run.golden_video = value;
+        else if(key == "audio") run.golden_audio = value;
+        else {
+          std::cerr << manifest_path << ":" << manifest_lines.size()
+                    << ": unknown field \"" << field << "\"\n";
+          valid = false;
+        }
+      }
+      if(run.frames == 0 && run.movie_arg.empty()) {
+        std::cerr << manifest_path << ":" << manifest_lines.size()
+                  << ": a frame count of 0 needs a movie\n";
+        valid = false;
+      }
+      if(run.golden_video.empty() && run.golden_audio.empty()
+         && !update_goldens) {
+        std::cerr << manifest_path << ":" << manifest_lines.size()
+                  << ": no video or audio hash (use -u to record them)\n";
+        valid = false;
+      }
+      run.rom = relative_to_manifest(run.rom_arg);
+      if(!run.movie_arg.empty())
+        run.movie = relative_to_manifest(run.movie_arg);
+      run.line = manifest_lines.size() - 1;
+      runs.push_back(run);
+    }
+    return valid;
+  }
+  bool save_manifest() {
+    for(auto& run : runs) {
+      if(!run.ran) continue;
+      std::string& line = manifest_lines[run.line];
+      auto comment = line.find('#');
+      std::ostringstream out;
+      out << run.rom_arg << " " << run.frames;
+      if(!run.movie_arg.empty()) out << " movie=" << run.movie_arg;
+      out << " video=" << run.video << " audio=" << run.audio;
+      if(comment != std::string::npos) out << " " << line.substr(comment);
+      line = out.str();
+    }
+    std::ofstream out(manifest_path);
+    for(auto& line : manifest_lines) out << line << "\n";
+    out.close();
+    if(!out) {
+      std::cerr << manifest_path << ": could not write\n";
+      return false;
+    }
+    return true;
+  }
+  void execute(Run& run) {
+    std::string command = quote(emulator_path) + " -H "
+      + std::to_string(run.frames) + " -Y";
+    if(!run.movie.empty()) command += " -m " + quote(run.movie);
+    if(!extra_args.empty()) command += " " + extra_args;
+    command += " -- " + quote(run.rom) + " 2>&1";
+    FILE* f = popen(command.c_str(), "r");
+    if(f == nullptr) {
+      run.error = "could not start the emulator";
+      return;
+    }
+    std::string last_line;
+    char buf[512];
+    while(fgets(buf, sizeof(buf), f)) {
+      std::string line = buf;
+      while(!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+        line.pop_back();
+      if(!line.empty()) last_line = line;
+      // ars-emu prints exactly one of these, untranslated, with -Y
+      char video[17], audio[17];
+      if(sscanf(line.c_str(),
+                "ARS-REGRESS frames=%lld seconds=%lf video=%16s audio=%16s",
+                &run.frames_run, &run.seconds, video, audio) == 4) {
+        run.video = video;
+        run.audio = audio;
+        run.ran = true;
+      }
+    }
+    int status = pclose(f);
+    if(!run.ran)
+      run.error = last_line.empty() ? "emulator exited with status "
+        + std::to_string(status) : last_line;
+  }
+  int worker_body(void*) {
+    size_t n;
+    while((n = next_run++) < runs.size()) {
+      execute(runs[n]);
+      std::lock_guard<std::mutex> lock(progress_lock);
+      std::cerr << "." << std::flush;
+    }
+    return 0;
+  }
+  bool parse_command_line(int argc, const char** argv) {
+    int n = 1;
+    bool noMoreOptions = false;
+    bool valid = true;
+    while(n < argc) {
+      const char* arg = argv[n++];
+      if(!strcmp(arg, "--")) noMoreOptions = true;
+      else if(!noMoreOptions && arg[0] == '-') {
+        ++arg;
+        while(*arg) {
+          char opt = *arg++;
+          switch(opt) {
+          case '?': print_usage(); return false;
+          case 'u': update_goldens = true; break;
+          case 'e':
+          case 'j':
+          case 'a':
+            if(n >= argc) {
+              std::cerr << "Missing argument for -" << opt << "\n";
+              valid = false;
+            }
+            else if(opt == 'e') emulator_path = argv[n++];
+            else if(opt == 'a') extra_args = argv[n++];
+            else {
+              job_count = std::stoul(argv[n++]);
+              if(job_count > 128) job_count = 128;
+            }
+            break;
+          default:
+            std::cerr << "Unknown option: -" << opt << "\n";
+            valid = false;
+          }
+        }
+      }
+      else if(!manifest_path.empty()) {
+        std::cerr << "More than one manifest specified\n";
+        valid = false;
+      }
+      else manifest_path = arg;
+    }
+    if(valid && manifest_path.empty()) {
+      std::cerr << "No manifest specified\n";
+      valid = false;
+    }
+    if(!valid) {
+      print_usage();
+      return false;
+    }
+    if(emulator_path.empty()) {
+      // bin/ars-regress-release -> bin/ars-emu-release
+      emulator_path = argv[0];
+      auto p = emulator_path.rfind("ars-regress");
+      if(p == std::string::npos) emulator_path = "ars-emu";
+      else emulator_path.replace(p, strlen("ars-regress"), "ars-emu");
+    }
+    return true;
+  }
+}
+
+extern "C" int teg_main(int argc, char** argv) {
+  if(!parse_command_line(argc, const_cast<const char**>(argv))) return 1;
+  if(!load_manifest()) return 1;
+  if(SDL_Init(0)) return 1;
+  atexit(SDL_Quit);
+  if(job_count == 0) {
+    int cpus = SDL_GetCPUCount();
+    job_count = cpus < 1 ? 1 : cpus;
+  }
+  if(job_count > runs.size()) job_count = runs.size();
+  next_run = 0;
+  std::vector<SDL_Thread*> workers;
+  // this thread is one of the workers
+  for(unsigned int n = 1; n < job_count; ++n) {
+    SDL_Thread* thread = SDL_CreateThread(worker_body, "regress", nullptr);
+    if(thread == nullptr) break;
+    workers.push_back(thread);
+  }
+  worker_body(nullptr);
+  for(auto thread : workers) SDL_WaitThread(thread, nullptr);
+  std::cerr << "\n";
+  int passed = 0, failed = 0, fresh = 0, errors = 0;
+  for(auto& run : runs) {
+    std::string name = run.rom_arg;
+    if(!run.movie_arg.empty()) name += " + " + run.movie_arg;
+    if(!run.ran) {
+      std::cout << "ERROR " << name << ": " << run.error << "\n";
+      ++errors;
+      continue;
+    }
+    const char* status;
+    if(run.golden_video.empty() && run.golden_audio.empty()) {
+      status = "NEW  ";
+      ++fresh;
+    }
+    else if((run.golden_video.empty() || run.golden_video == run.video)
+            && (run.golden_audio.empty() || run.golden_audio == run.audio)) {
+      status = "PASS ";
+      ++passed;
+    }
+    else {
+      status = "FAIL ";
+      ++failed;
+    }
+    double fps = run.seconds > 0 ? run.frames_run / run.seconds : 0;
+    std::cout << status << name << ": " << run.frames_run << " frames, "
+              << std::fixed << std::setprecision(1) << fps << " fps\n";
+    if(run.golden_video != run.video && !run.golden_video.empty())
+      std::cout << "  video " << run.video << ", expected "
+                << run.golden_video << "\n";
+    if(run.golden_audio != run.audio && !run.golden_audio.empty())
+      std::cout << "  audio " << run.audio << ", expected "
+                << run.golden_audio << "\n";
+  }
+  std::cout << passed << " passed, " << failed << " failed, " << fresh
+            << " new, " << errors << " errors\n";
+  if(update_goldens && !save_manifest()) return 1;
+  return (failed || errors) ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+#include "audio_capture.hh"
+#include "io.hh"
+
+#include <atomic>
+#include <cmath>
+
+using namespace ARS;
+
+namespace {
+  constexpr int CHANNELS = 5;
+  constexpr int SCALE = 64;
+  // about 22 seconds; a power of two
+  constexpr size_t RING_FRAMES = 1 << 20;
+  // the writer is woken up every time this many frames have been pushed
+  constexpr size_t WAKE_FRAMES = 1 << 14;
+  std::unique_ptr<int16_t[]> ring;
+  // frame counts since start, never wrapped
+  std::atomic<size_t> write_pos, read_pos;
+  std::atomic<uint64_t> dropped_frames;
+  std::atomic<bool> active{false}, stopping;
+  std::unique_ptr<std::ostream> out;
+  std::string out_path;
+  SDL_sem* wake;
+  SDL_Thread* writer;
+  int writer_body(void*) {
+    while(true) {
+      // if we were told to stop before draining, the producer is done and
+      // this drain is the last one
+      bool last = stopping;
+      size_t rd = read_pos.load(std::memory_order_relaxed);
+      size_t wr = write_pos.load(std::memory_order_acquire);
+      while(rd != wr) {
+        size_t start = rd % RING_FRAMES;
+        size_t count = std::min(wr - rd, RING_FRAMES - start);
+        int16_t* p = &ring[start * CHANNELS];
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+        for(size_t n = 0; n < count * CHANNELS; ++n) p[n] = SDL_SwapLE16(p[n]);
+#endif
+        out->write(reinterpret_cast<const char*>(p),
+                   count * CHANNELS * sizeof(int16_t));
+        rd += count;
+        read_pos.store(rd, std::memory_order_release);
+      }
+      if(last) break;
+      SDL_SemWaitTimeout(wake, 100);
+    }
+    return 0;
+  }
+}
+
+bool AudioCapture::start(const std::string& path) {
+  stop();
+  out = IO::OpenRawPathForWrite(path);
+  if(!out || !*out) {
+    sn.Out(std::cerr, "AUDIO_CAPTURE_FAILED_TO_OPEN"_Key, {path});
+    out.reset();
+    return false;
+  }
+  out_path = path;
+  if(!ring) ring.reset(new int16_t[RING_FRAMES * CHANNELS]);
+  write_pos = 0;
+  read_pos = 0;
+  dropped_frames = 0;
+  stopping = false;
+  wake = SDL_CreateSemaphore(0);
+  if(wake == nullptr)
+    die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+  writer = SDL_CreateThread(writer_body, "audio capture", nullptr);
+  if(writer == nullptr)
+    die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+  active = true;
+  return true;
+}
+
+void AudioCapture::stop() {
+  if(!active) return;
+  active = false;
+  stopping = true;
+  SDL_SemPost(wake);
+  SDL_WaitThread(writer, nullptr);
+  SDL_DestroySemaphore(wake);
+  out->flush();
+  if(!*out)
+    sn.Out(std::cerr, "AUDIO_CAPTURE_WRITE_FAILED"_Key, {out_path});
+  out.reset();
+  if(dropped_frames > 0)
+    sn.Out(std::cerr, "AUDIO_CAPTURE_DROPPED_FRAMES"_Key,
+           {TEG::format("%llu",
+                        (unsigned long long)dropped_frames.load())});
+}
+
+bool AudioCapture::isActive() {
+  return active.load(std::memory_order_relaxed);
+}
+
+void AudioCapture::push(const int16_t* et209_frames, const float* floppy_frames,
+                        size_t count) {
+  if(!isActive()) return;
+  size_t wr = write_pos.load(std::memory_order_relaxed);
+  size_t rd = read_pos.load(std::memory_order_acquire);
+  size_t space = RING_FRAMES - (wr - rd);
+  if(count > space) {
+    dropped_frames.fetch_add(count - space, std::memory_order_relaxed);
+    count = space;
+  }
+  for(size_t n = 0; n < count; ++n) {
+    int16_t* p = &ring[((wr + n) % RING_FRAMES) * CHANNELS];
+    for(int c = 0; c < 4; ++c) p[c] = et209_frames[n * 4 + c] * SCALE;
+    // floppy samples are already floats on the same scale as ET209 output
+    // divided by 256
+    p[4] = static_cast<int16_t>(std::lround(floppy_frames[n] * 256 * SCALE));
+  }
+  write_pos.store(wr + count, std::memory_order_release);
+  if((wr + count) / WAKE_FRAMES != wr / WAKE_FRAMES) SDL_SemPost(wake);
+}
@@ -1,6 +1,9 @@
 #include "audiocvt.hh"
 
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace {
   constexpr float SAMPLE_RATE = 47988.28125f;
@@ -38,6 +41,147 @@ namespace {
       return false;
     }
   };
+  /* A bank of windowed-sinc filters, one per fractional position ("phase")
+     between two input frames. Row p is the filter for an output frame that
+     falls p/PHASES of the way from tap TAPS/2-1 to tap TAPS/2. There is one
+     more row than there are phases, so that the filters for any position can
+     be interpolated from two adjacent rows without wrapping. */
+  constexpr int PHASES = 256;
+  constexpr double PI = 3.14159265358979323846;
+  // taps are processed this many at a time, in independent lanes, so that
+  // the compiler can vectorize the inner loop without reassociating floats
+  constexpr int LANES = 8;
+  struct FilterBank {
+    const int taps;
+    std::vector<float> coefficients; // (PHASES+1) * taps
+    FilterBank(int taps, float cutoff, float beta)
+      : taps(taps), coefficients((PHASES+1) * taps) {
+      // zeroth-order modified Bessel function of the first kind, for the
+      // Kaiser window
+      auto I0 = [](double x) {
+        double sum = 1, term = 1;
+        for(int k = 1; k < 32; ++k) {
+          term *= (x / (2*k)) * (x / (2*k));
+          sum += term;
+        }
+        return sum;
+      };
+      const double half = taps / 2.0;
+      const double window_scale = 1 / I0(beta);
+      for(int p = 0; p <= PHASES; ++p) {
+        float* row = &coefficients[p * taps];
+        double sum = 0;
+        for(int k = 0; k < taps; ++k) {
+          double t = k - (taps/2 - 1) - static_cast<double>(p) / PHASES;
+          double sinc = t == 0 ? cutoff
+            : std::sin(PI * cutoff * t) / (PI * t);
+          double w = t / half;
+          double window = std::abs(w) >= 1 ? 0
+            : I0(beta * std::sqrt(1 - w * w)) * window_scale;
+          row[k] = sinc * window;
+          sum += row[k];
+        }
+        // unity gain at DC for every phase, or we'd get phase-dependent hum
+        for(int k = 0; k < taps; ++k) row[k] /= sum;
+      }
+    }
+  };
+  int getTaps(bool long_filter) { return long_filter ? 64 : 32; }
+  float getBeta(bool long_filter) { return long_filter ? 9.f : 6.f; }
+  /* Banks only depend on the tap count and the cutoff, and the dynamic sync
+     code only nudges the source rate by a fraction of a percent, so the
+     cutoff is rounded enough that the rates it picks share a few banks. */
+  int getCutoffKey(float source_rate, float dest_rate) {
+    // cut off a little short of the lower of the two Nyquist frequencies
+    float cutoff = std::min(1.f, dest_rate / source_rate) * 0.9f;
+    return static_cast<int>(std::round(cutoff * 256));
+  }
+  /* Building a bank is slow, and SincCvts are made in the audio callback,
+     so PrepareAudioCvt builds every bank they'll need ahead of time, on the
+     main thread. Building one here is only a fallback. */
+  std::shared_ptr<const FilterBank> getFilterBank(int taps, int cutoff_key,
+                                                  float beta) {
+    static std::mutex lock;
+    static std::map<std::pair<int, int>, std::shared_ptr<const FilterBank>>
+      banks;
+    std::lock_guard<std::mutex> guard(lock);
+    auto& ret = banks[std::make_pair(taps, cutoff_key)];
+    if(!ret) ret = std::make_shared<const FilterBank>(taps, cutoff_key / 256.f,
+                                                      beta);
+    return ret;
+  }
+  bool usesNearestNeighbor(int quality_hint, float dest_rate) {
+    return quality_hint < 0
+      || (quality_hint == 0
+          && dest_rate > MINIMUM_CLOSE_SAMPLE_RATE
+          && dest_rate < MAXIMUM_CLOSE_SAMPLE_RATE);
+  }
+  template<int CHANNELS> class SincCvt : public AudioCvt {
+    std::shared_ptr<const FilterBank> bank;
+    const int taps;
+    // input frames advanced per output frame
+    const double step;
+    // position of the next output frame's first tap within the history
+    double pos;
+    // one buffer per channel: the last taps-1 frames of the previous input,
+    // followed by the current input
+    std::vector<float> history[CHANNELS];
+  public:
+    SincCvt(int number_of_input_frames,
+            float source_rate, float dest_rate, bool long_filter)
+      : AudioCvt(number_of_input_frames, CHANNELS,
+                 static_cast<int>(std::ceil(number_of_input_frames
+                                            *dest_rate/source_rate)) + 1),
+        taps(getTaps(long_filter)),
+        step(static_cast<double>(source_rate) / dest_rate), pos(0) {
+      bank = getFilterBank(taps, getCutoffKey(source_rate, dest_rate),
+                           getBeta(long_filter));
+      for(auto& buf : history)
+        buf.resize(taps - 1 + number_of_input_frames, 0.f);
+    }
+    ~SincCvt() {}
+    void ConvertMore(const float* in) override {
+      const int kept = taps - 1;
+      for(int c = 0; c < CHANNELS; ++c) {
+        float* buf = history[c].data();
+        std::copy(buf + number_of_input_frames,
+                  buf + number_of_input_frames + kept, buf);
+        for(int n = 0; n < number_of_input_frames; ++n)
+          buf[kept + n] = in[n * CHANNELS + c];
+      }
+      float* outp = output_buffer;
+      const float* coefficients = bank->coefficients.data();
+      while(pos < number_of_input_frames) {
+        int base = static_cast<int>(pos);
+        float phase = static_cast<float>((pos - base) * PHASES);
+        int row = static_cast<int>(phase);
+        float frac = phase - row;
+        const float* h0 = coefficients + row * taps;
+        const float* h1 = h0 + taps;
+        for(int c = 0; c < CHANNELS; ++c) {
+          const float* x = history[c].data() + base;
+          float acc[LANES] = {};
+          for(int k = 0; k < taps; k += LANES) {
+            for(int l = 0; l < LANES; ++l) {
+              float h = h0[k+l] + (h1[k+l] - h0[k+l]) * frac;
+              acc[l] += h * x[k+l];
+            }
+          }
+          float sum = 0;
+          for(int l = 0; l < LANES; ++l) sum += acc[l];
+          *outp++ = sum;
+        }
+        pos += step;
+      }
+      pos -= number_of_input_frames;
+      position_in_output_buffer = output_buffer;
+      end_of_output_buffer = outp;
+    }
+    bool NeedsLap() override {
+      // a fresh SincCvt starts with silence in its history
+      return true;
+    }
+  };
   // Originally, we planned to use SDL_AudioCVT. As it turns out, SDL_AudioCVT
   // has numerous technical issues that prevent us from using it.
 }
@@ -47,11 +191,7 @@ std::unique_ptr<AudioCvt> MakeAudioCvt(int quality_hint,
                                        float dest_rate,
                                        int number_of_input_samples,
                                        int input_channels) {
-  if(true
-     || quality_hint < 0
-     || (quality_hint == 0
-         && source_rate > MINIMUM_CLOSE_SAMPLE_RATE
-         && source_rate < MAXIMUM_CLOSE_SAMPLE_RATE)) {
+  if(usesNearestNeighbor(quality_hint, dest_rate)) {
     // nearest neighbor
     switch(input_channels) {
     case 1:
@@ -72,6 +212,34 @@ std::unique_ptr<AudioCvt> MakeAudioCvt(int quality_hint,
     }
   }
   else {
-    // TODO: other resamplers
+    // windowed sinc
+    bool long_filter = quality_hint >= 2;
+    switch(input_channels) {
+    case 1:
+      return std::make_unique<SincCvt<1>>
+        (number_of_input_samples, source_rate, dest_rate, long_filter);
+    case 2:
+      return std::make_unique<SincCvt<2>>
+        (number_of_input_samples/2, source_rate, dest_rate, long_filter);
+    case 3:
+      return std::make_unique<SincCvt<3>>
+        (number_of_input_samples/3, source_rate, dest_rate, long_filter);
+    case 4:
+      return std::make_unique<SincCvt<4>>
+        (number_of_input_samples/4, source_rate, dest_rate, long_filter);
+    default:
+      die("Internal error: wrong number of channels for MakeAudioCvt (%i)",
+          input_channels);
+    }
   }
 }
+
+void PrepareAudioCvt(int quality_hint, float min_source_rate,
+                     float max_source_rate, float dest_rate) {
+  if(usesNearestNeighbor(quality_hint, dest_rate)) return;
+  bool long_filter = quality_hint >= 2;
+  // (a higher source rate means a lower cutoff)
+  for(int key = getCutoffKey(max_source_rate, dest_rate);
+      key <= getCutoffKey(min_source_rate, dest_rate); ++key)
+    getFilterBank(getTaps(long_filter), key, getBeta(long_filter));
+}
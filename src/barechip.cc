@@ -14,6 +14,11 @@ namespace {
     void oncePerFrame() override {
       mem->oncePerFrame();
     }
+    const uint8_t* getReadPage(uint8_t bank, uint16_t addr) override {
+      return mem->getPage((addr & 0x7FFF) | (bank << 15));
+    }
+    void freeze(ARS::Freezer& f) override { mem->freeze(f); }
+    void defrost(ARS::Defroster& d) override { mem->defrost(d); }
   };
 }
 
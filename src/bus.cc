@@ -0,0 +1,135 @@
+#include "ars-emu.hh"
+#include "ppu.hh"
+#include "apu.hh"
+#include "cartridge.hh"
+#include "expansions.hh"
+#include "configurator.hh"
+#include "teg.hh"
+
+/*
+
+  The CPU's view of the bus, past the page tables that ARS::read and
+  ARS::write in ars-emu.hh take care of themselves. This is its own unit so
+  that busbench can time it as it is.
+
+ */
+
+using namespace ARS;
+
+namespace {
+  void badread(uint16_t addr) {
+    ui << sn.Get("BAD_READ"_Key, {TEG::format("%04X",addr)}) << ui;
+  }
+  void badwrite(uint16_t addr) {
+    ui << sn.Get("BAD_WRITE"_Key, {TEG::format("%04X",addr)}) << ui;
+  }
+  void busconflict(uint16_t addr, std::string bus) {
+    ui << sn.Get("BUS_CONFLICT"_Key, {TEG::format("%04X",addr), std::move(bus)}) << ui;
+  }
+  // the pages of bank slots start through stop-1 ($8000-8FFF is slot 0)
+  void rebuildBankPages(unsigned int start, unsigned int stop) {
+    constexpr unsigned int PAGES_PER_SLOT = 0x1000 >> BUS_PAGE_SHIFT;
+    auto& cartridge = board->cartridge;
+    for(unsigned int n = (8 + start) * PAGES_PER_SLOT;
+        n < (8 + stop) * PAGES_PER_SLOT; ++n) {
+      uint16_t base = n << BUS_PAGE_SHIFT;
+      board->read_pages[n] = cartridge
+        ? cartridge->getReadPage(board->bankMap[(base>>12)-8], base)
+        : nullptr;
+      // cartridge memories track their own dirtiness
+      board->write_pages[n] = nullptr;
+    }
+  }
+}
+
+uint8_t ARS::slowRead(uint16_t addr, bool OL, bool VPB, bool SYNC) {
+  // TODO: detect bus conflicts
+  if(SYNC) board->last_known_pc = addr;
+  (void)busconflict;
+  if(addr < 0x8000) {
+    if((addr & 0xFFF9) == 0x0211)
+      return PPU::complexRead(addr);
+    else if((addr & 0xFFF8) == 0x0240) {
+      auto& expansion = board->expansions[addr&7];
+      if(expansion) return expansion->input();
+      else {
+        // let spurious debug port reads/writes slide
+        if(addr != 0x247) badread(addr);
+        return 0xBB;
+      }
+    }
+    else return board->dram[addr];
+  }
+  else return board->cartridge->read(board->bankMap[(addr>>12)-8], addr,
+                                     OL, VPB, SYNC);
+  badread(addr);
+  return 0xBB;
+}
+
+void ARS::slowWrite(uint16_t addr, uint8_t value) {
+  // TODO: detect bus conflicts
+  (void)busconflict;
+  if(addr < 0x8000) {
+    // prevent writes to SimpleConfig's working or display memory as long as
+    // the configurator is in use
+    if(allow_secure_config_port
+       && Configurator::is_protected_memory_address(addr)
+       && !Configurator::is_secure_configuration_address(board->last_known_pc)
+       && Configurator::is_active())
+      return;
+    board->dram[addr] = value;
+    if(addr >= 0x0200 && addr < 0x0250) {
+      if((addr ^ 0x0210) < 16) PPU::complexWrite(addr, value);
+      else if((addr & 0xFFE0) == 0x0220) write_apu(addr&0x1F, value);
+      else if((addr & 0xFFF0) == 0x0240) {
+        if(addr >= 0x0248) {
+          auto bs = board->cartridge->getBS();
+          auto startBank = (addr&7)&~(7>>bs);
+          auto stopBank = ((addr&7)|(7>>bs))+1;
+          board->secure_config_port_checked = false;
+          for(auto n = startBank; n < stopBank; ++n) {
+            board->bankMap[n] = value;
+          }
+          rebuildBankPages(startBank, stopBank);
+        }
+        else {
+          auto& expansion = board->expansions[addr&7];
+          if(expansion) expansion->output(value);
+          // let spurious debug port reads/writes slide
+          else if(addr != 0x247) badwrite(addr);
+        }
+      }
+    }
+    return;
+  }
+  else {
+    board->cartridge->write(board->bankMap[(addr>>12)-8], addr, value);
+    return;
+  }
+  badwrite(addr);
+}
+
+void ARS::rebuildPageTables() {
+  constexpr unsigned int DRAM_PAGES = 0x8000 >> BUS_PAGE_SHIFT;
+  constexpr unsigned int REGISTER_PAGE = 0x0200 >> BUS_PAGE_SHIFT;
+  auto& read_pages = board->read_pages;
+  auto& write_pages = board->write_pages;
+  uint8_t* dram = board->dram;
+  for(unsigned int n = 0; n < DRAM_PAGES; ++n) {
+    uint16_t base = n << BUS_PAGE_SHIFT;
+    if(n == REGISTER_PAGE) {
+      read_pages[n] = nullptr;
+      write_pages[n] = nullptr;
+      continue;
+    }
+    read_pages[n] = dram + base;
+    // The configurator's memory protection has to see these writes. No
+    // protected range lies strictly inside a page, so a page has protected
+    // memory in it if and only if one of its ends is protected.
+    write_pages[n] = allow_secure_config_port
+      && (Configurator::is_protected_memory_address(base)
+          || Configurator::is_protected_memory_address(base + BUS_PAGE_MASK))
+      ? nullptr : dram + base;
+  }
+  rebuildBankPages(0, 8);
+}
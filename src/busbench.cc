@@ -0,0 +1,232 @@
+#include "ars-emu.hh"
+#include "cpu.hh"
+#include "cartridge.hh"
+#include "expansions.hh"
+#include "configurator.hh"
+#include "ppu.hh"
+#include "apu.hh"
+#include "teg.hh"
+
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+
+/*
+
+  Times ARS::read and ARS::write against the slowRead and slowWrite they fall
+  back on (both from bus.cc, as the emulator has them), on a board with
+  nothing on it but DRAM and a bare 256KiB ROM. The devices behind the
+  registers are stubbed out; nothing here touches them, and every access
+  still goes through the same chain of checks it does in the emulator.
+
+ */
+
+SN::Context sn;
+thread_local ARS::MessageImp ARS::ui;
+void ARS::MessageImp::outputBuffer() {}
+
+__thread ARS::MainBoard* ARS::board;
+ARS::MainBoard::MainBoard() : dram() {}
+ARS::MainBoard::~MainBoard() {}
+
+// as the emulator has them, without -z or -C
+bool ARS::always_allow_config_port = false,
+  ARS::allow_secure_config_port = true;
+bool ARS::Configurator::is_active() { return false; }
+uint8_t ARS::PPU::complexRead(uint16_t) { return 0xBB; }
+void ARS::PPU::complexWrite(uint16_t, uint8_t) {}
+void ARS::write_apu(uint8_t, uint8_t) {}
+
+namespace {
+  uint8_t rom[0x40000];
+  class BenchCartridge : public ARS::Cartridge {
+  public:
+    uint8_t read(uint8_t bank, uint16_t addr, bool, bool, bool) override {
+      return rom[((addr & 0x7FFF) | (bank << 15)) & (sizeof(rom) - 1)];
+    }
+    void write(uint8_t, uint16_t, uint8_t) override {}
+    void oncePerFrame() override {}
+    const uint8_t* getReadPage(uint8_t bank, uint16_t addr) override {
+      return rom + (((addr & 0x7FFF & ~ARS::BUS_PAGE_MASK) | (bank << 15))
+                    & (sizeof(rom) - 1));
+    }
+  };
+}
+
+namespace {
+  ARS::MainBoard main_board;
+  // a mix of DRAM (outside the register page, but including zero page and
+  // the stack, which games hit the most) and ROM addresses, like what a
+  // game's loads and fetches look like to the bus
+  uint16_t addresses[4096];
+  constexpr unsigned int ACCESSES_PER_RUN = 256;
+  volatile uint8_t sink;
+  struct test {
+    const std::string name;
+    const std::function<void()> func;
+    bool enabled = true;
+  };
+  test tests[] = {
+    {"read_slow", []() {
+        uint8_t sum = 0;
+        for(unsigned int run = 0; run < ACCESSES_PER_RUN; ++run) {
+          for(unsigned int n = 0; n < elementcount(addresses); ++n)
+            sum += ARS::slowRead(addresses[n], false, false, n & 1);
+        }
+        sink = sum;
+      }},
+    {"read_paged", []() {
+        uint8_t sum = 0;
+        for(unsigned int run = 0; run < ACCESSES_PER_RUN; ++run) {
+          for(unsigned int n = 0; n < elementcount(addresses); ++n)
+            sum += ARS::read(addresses[n], false, false, n & 1);
+        }
+        sink = sum;
+      }},
+    {"write_slow", []() {
+        for(unsigned int run = 0; run < ACCESSES_PER_RUN; ++run) {
+          for(unsigned int n = 0; n < elementcount(addresses); ++n)
+            ARS::slowWrite(addresses[n] & 0x7FFF, n);
+        }
+      }},
+    {"write_paged", []() {
+        for(unsigned int run = 0; run < ACCESSES_PER_RUN; ++run) {
+          for(unsigned int n = 0; n < elementcount(addresses); ++n)
+            ARS::write(addresses[n] & 0x7FFF, n);
+        }
+      }},
+  };
+  constexpr unsigned int DEFAULT_ITERATION_COUNT = 10;
+  unsigned int iteration_count = DEFAULT_ITERATION_COUNT;
+  void print_usage() {
+    std::cout << "Usage: busbench [options] [testnames]\n"
+      "Options:\n"
+      "-L: List all known tests\n"
+      "-i: Number of iterations for each test, default is "<<DEFAULT_ITERATION_COUNT<<"\n";
+  }
+  void print_tests() {
+    for(auto& test : tests) {
+      std::cout << test.name << "\n";
+    }
+  }
+  bool parse_command_line(int argc, const char** argv) {
+    int n = 1;
+    bool noMoreOptions = false;
+    bool valid = true;
+    bool any_tests_specified = false;
+    while(n < argc) {
+      const char* arg = argv[n++];
+      if(!strcmp(arg, "--")) noMoreOptions = true;
+      else if(!noMoreOptions && arg[0] == '-') {
+        ++arg;
+        while(*arg) {
+          switch(*arg++) {
+          case '?': print_usage(); return false;
+          case 'L': print_tests(); return false;
+          case 'i':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-i"});
+              valid = false;
+            }
+            else {
+              iteration_count = std::stoul(argv[n++]);
+              if(iteration_count > 10000) iteration_count = 10000;
+              else if(iteration_count < 1) iteration_count = 1;
+            }
+            break;
+          default:
+            sn.Out(std::cerr, "UNKNOWN_OPTION"_Key, {std::string(arg-1,1)});
+            valid = false;
+          }
+        }
+      }
+      else {
+        if(!any_tests_specified) {
+          any_tests_specified = true;
+          for(auto& test : tests) {
+            test.enabled = false;
+          }
+        }
+        bool found = false;
+        for(auto& test : tests) {
+          if(test.name == arg) {
+            found = true;
+            test.enabled = true;
+            break;
+          }
+        }
+        if(!found) {
+          std::cerr << "Unknown test name: " << arg << "\n";
+        }
+      }
+    }
+    if(!valid) {
+      print_usage();
+      return false;
+    }
+    return true;
+  }
+}
+
+extern "C" int teg_main(int argc, char** argv) {
+  if(!parse_command_line(argc, const_cast<const char**>(argv))) return 1;
+  ARS::board = &main_board;
+  main_board.cartridge = std::make_unique<BenchCartridge>();
+  for(unsigned int n = 0; n < 8; ++n) main_board.bankMap[n] = n;
+  ARS::rebuildPageTables();
+  for(auto& byte : rom) byte = rand();
+  for(unsigned int n = 0; n < elementcount(addresses); ++n) {
+    uint16_t& addr = addresses[n];
+    // a quarter of them in zero page or the stack
+    if(n % 4 == 0) addr = rand() & 0x01FF;
+    else {
+      do addr = rand();
+      while((addr & 0x7F00) == 0x0200);
+    }
+  }
+  std::cout << "[";
+  std::vector<double> execution_times(iteration_count);
+  bool first_test = true;
+  for(auto& test : tests) {
+    if(!test.enabled) continue;
+    // dry run to heat up instruction caches and branch predictor
+    test.func();
+    for(unsigned int i = 0; i < iteration_count; ++i) {
+      auto begin_time = std::chrono::high_resolution_clock::now();
+      test.func();
+      auto end_time = std::chrono::high_resolution_clock::now();
+      execution_times[i] =
+        std::chrono::duration_cast<std::chrono::duration<double,
+                                                         std::ratio<1,1>>>
+        (end_time - begin_time).count();
+    }
+    std::sort(execution_times.begin(), execution_times.end());
+    if(!first_test) std::cout << ",";
+    else first_test = false;
+    std::cout << "\n{\"name\":\"" << test.name << "\"";
+    // minimum time
+    std::cout << ",\"min\":" << std::fixed << std::setprecision(6)
+              << execution_times[0];
+    // average time
+    double total = 0;
+    for(auto time : execution_times) total += time;
+    std::cout << ",\"mean\":" << std::fixed << std::setprecision(6)
+              << (total/iteration_count);
+    // median
+    if(iteration_count % 2 == 0) {
+      std::cout << ",\"median\":" << std::fixed << std::setprecision(6)
+                << (execution_times[iteration_count/2-1]
+                    +execution_times[iteration_count/2])/2;
+    }
+    else {
+      std::cout << ",\"median\":" << std::fixed << std::setprecision(6)
+                << execution_times[iteration_count/2];
+    }
+    // maximum time
+    std::cout << ",\"max\":" << std::fixed << std::setprecision(6)
+              << execution_times[iteration_count-1];
+    std::cout << "}";
+  }
+  std::cout << "\n]\n";
+  return 0;
+}
@@ -49,11 +49,12 @@ namespace {
     void write(uint32_t address, uint8_t value) override {
       memory_buffer[address&mask] = value;
     }
+    void freeze(Freezer& f) override { freezeContents(f); }
+    void defrost(Defroster& d) override { defrostContents(d); }
     ~PadRAM() { delete[] memory_buffer; }
   };
 }
 
-std::unique_ptr<Cartridge> ARS::cartridge;
 const std::unordered_map<std::string, std::function<std::unique_ptr<Cartridge>(byuuML::cursor mapper_tag, std::unordered_map<std::string, std::unique_ptr<Memory> >)> > ARS::mapper_types {
   {"", ARS::Mappers::MakeBareChip},
   {"devcart", ARS::Mappers::MakeDevCart},
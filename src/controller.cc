@@ -2,6 +2,7 @@
 #include "teg.hh"
 #include "controller.hh"
 #include "display.hh"
+#include "movie.hh"
 
 #include "prefs.hh"
 #include "config.hh"
@@ -159,6 +160,16 @@ namespace {
     {SDL_SCANCODE_F3, NO_SCANCODE},
     /* Take Screenshot */
     {SDL_SCANCODE_F12, SDL_SCANCODE_PRINTSCREEN},
+    /* Freeze */
+    {SDL_SCANCODE_F5, NO_SCANCODE},
+    /* Defrost */
+    {SDL_SCANCODE_F9, NO_SCANCODE},
+    /* Rewind */
+    {SDL_SCANCODE_BACKSPACE, NO_SCANCODE},
+    /* Fast Forward */
+    {SDL_SCANCODE_GRAVE, NO_SCANCODE},
+    /* Audio Stats */
+    {SDL_SCANCODE_F6, NO_SCANCODE},
   };
   int keybindings[NUM_PLAYERS][NUM_BUTTONS][MAX_KEYS_PER_BUTTON];
   int emukeybindings[NUM_EMULATOR_BUTTONS][MAX_KEYS_PER_BUTTON];
@@ -205,6 +216,16 @@ namespace {
     {"EMU_toggle_ol_alt",  emukeybindings[3][1]},
     {"EMU_screenshot",     emukeybindings[4][0]},
     {"EMU_screenshot_alt", emukeybindings[4][1]},
+    {"EMU_freeze",         emukeybindings[5][0]},
+    {"EMU_freeze_alt",     emukeybindings[5][1]},
+    {"EMU_defrost",        emukeybindings[6][0]},
+    {"EMU_defrost_alt",    emukeybindings[6][1]},
+    {"EMU_rewind",         emukeybindings[7][0]},
+    {"EMU_rewind_alt",     emukeybindings[7][1]},
+    {"EMU_fast_forward",   emukeybindings[8][0]},
+    {"EMU_fast_forward_alt", emukeybindings[8][1]},
+    {"EMU_audio_stats",    emukeybindings[9][0]},
+    {"EMU_audio_stats_alt", emukeybindings[9][1]},
   };
   class KBPrefsLogic : public PrefsLogic {
   protected:
@@ -358,6 +379,16 @@ namespace {
     }
   public:
     LightGunController(int player) : player(player) {}
+    // the selector switch is the only state of its own the machine can see;
+    // the mouse state all controllers share is input, like buttonsPressed
+    void freeze(Freezer& f) override {
+      Controller::freeze(f);
+      f(selector);
+    }
+    void defrost(Defroster& d) override {
+      Controller::defrost(d);
+      d(selector);
+    }
   };
   std::string getScancodeName(int code) {
     SDL_Keycode key = SDL_GetKeyFromScancode(static_cast<SDL_Scancode>(code));
@@ -378,7 +409,13 @@ void Controller::output(uint8_t d) {
 uint8_t Controller::input() {
   if(strobeIsHigh) {
     strobeIsHigh = false;
-    dIn = onStrobeFall(dOut);
+    // there's only one movie, and it belongs to the primary machine
+    bool movie = board->primary;
+    if(movie && Movie::isPlaying()) dIn = Movie::playStrobe();
+    else {
+      dIn = onStrobeFall(dOut);
+      if(movie && Movie::isRecording()) Movie::recordStrobe(dIn);
+    }
     dataIsFresh = true;
   }
   if(dataIsFresh) {
@@ -388,6 +425,14 @@ uint8_t Controller::input() {
   else return dIn;
 }
 
+void Controller::freeze(Freezer& f) {
+  f(dOut); f(dIn); f(dataIsFresh); f(strobeIsHigh);
+}
+
+void Controller::defrost(Defroster& d) {
+  d(dOut); d(dIn); d(dataIsFresh); d(strobeIsHigh);
+}
+
 bool Controller::filterEvent(SDL_Event& evt) {
   switch(evt.type) {
   case SDL_CONTROLLERDEVICEADDED:
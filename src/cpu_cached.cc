@@ -0,0 +1,231 @@
+#include "ars-emu.hh"
+#include "cpu.hh"
+#include "ppu.hh"
+#include "apu.hh"
+#include "w65c02.hh"
+
+/*
+
+  Same Core, same bus traffic and same timing as CPU_Scanline, but code is
+  decoded ahead of time into blocks: straight-line runs of instructions, each
+  with its opcode and length. Inside a block, opcodes come from the block
+  instead of the bus, and the Core goes straight from one instruction to the
+  next for as long as nothing (an interrupt, SO, WAI, a jump) calls for the
+  full step(). Operands are still read from the bus; serving them from the
+  block too would put a check on every data read, which costs more than it
+  saves.
+
+  Only code the bus page tables can read directly is decoded, since those
+  reads have no side effects and always return what the host memory behind
+  the page holds. Blocks are found by host address, which amounts to keying
+  them by (bank, address): the same code under another bank is another
+  block, and a bank that's switched back in finds its blocks still there.
+
+  Each host page has a generation number, which every CPU write to it bumps;
+  a block is only good while its page's generation is the one it was decoded
+  under. This catches writes to DRAM and to cartridge RAM, through any
+  mirror, since a write lands in the same memory that reads of its address
+  see. A write to the current block's page, or to the bank registers
+  ($0248-$024F), also ends the current block on the spot, so that the next
+  opcode is looked up afresh. Anything else that replaces memory wholesale
+  (a reset, a defrost) throws every block away.
+
+  The opcode fetches a block saves still cost a cycle of budget each, so
+  runCycles lines up with scanlines exactly the way it does on the fast
+  core. cpucheck holds the two cores to that.
+
+ */
+
+namespace {
+  const uint8_t INSTRUCTION_LENGTH[256] = {
+    1, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // 0x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // 1x
+    3, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // 2x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // 3x
+    1, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // 4x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // 5x
+    1, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // 6x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // 7x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // 8x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // 9x
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // Ax
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // Bx
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // Cx
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // Dx
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3, // Ex
+    2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3, // Fx
+  };
+  // instructions that never fall through to the next one; a block stops
+  // after one of these, since what follows probably isn't code
+  bool endsBlock(uint8_t opcode) {
+    switch(opcode) {
+    case 0x00: // BRK
+    case 0x20: // JSR
+    case 0x40: // RTI
+    case 0x4C: case 0x6C: case 0x7C: // JMP
+    case 0x60: // RTS
+    case 0x80: // BRA
+    case 0xCB: // WAI
+    case 0xDB: // STP
+      return true;
+    default:
+      return false;
+    }
+  }
+  struct Instruction {
+    uint8_t opcode, length;
+  };
+  constexpr unsigned int MAX_BLOCK_INSTRUCTIONS = 64;
+  struct Block {
+    // host address of the first opcode; nullptr if the entry is unused
+    const uint8_t* code;
+    uint32_t epoch, generation;
+    uint8_t count;
+    Instruction instructions[MAX_BLOCK_INSTRUCTIONS];
+  };
+  // both must be powers of two
+  constexpr unsigned int BLOCK_CACHE_SIZE = 2048;
+  constexpr unsigned int GENERATION_COUNT = 4096;
+  class CPU_Cached : public ARS::CPU {
+    int cycle_budget = 0, run_start_budget = 0;
+    uint32_t audio_cycle_counter = 0;
+    W65C02::Core<CPU_Cached> core;
+    std::unique_ptr<Block[]> blocks;
+    // bumped to throw away every block at once
+    uint32_t epoch = 1;
+    // indexed by generationIndex; collisions only cost a spurious redecode
+    uint32_t generations[GENERATION_COUNT] = {};
+    // the host page of the block being run; null outside a block, or once a
+    // write has spoiled it
+    const uint8_t* cur_page = nullptr;
+    static unsigned int generationIndex(const uint8_t* page) {
+      return (reinterpret_cast<uintptr_t>(page) >> ARS::BUS_PAGE_SHIFT)
+        & (GENERATION_COUNT - 1);
+    }
+    static unsigned int blockIndex(const uint8_t* code) {
+      auto p = reinterpret_cast<uintptr_t>(code);
+      return (p ^ (p >> 11)) & (BLOCK_CACHE_SIZE - 1);
+    }
+    void decodeBlock(Block& block, const uint8_t* page, unsigned int offset,
+                     uint32_t generation) {
+      block.code = page + offset;
+      block.epoch = epoch;
+      block.generation = generation;
+      block.count = 0;
+      constexpr unsigned int PAGE_SIZE = 1 << ARS::BUS_PAGE_SHIFT;
+      while(block.count < MAX_BLOCK_INSTRUCTIONS) {
+        uint8_t opcode = page[offset];
+        uint8_t length = INSTRUCTION_LENGTH[opcode];
+        // an instruction that runs off the page is left to step()
+        if(offset + length > PAGE_SIZE) break;
+        block.instructions[block.count++] = {opcode, length};
+        offset += length;
+        if(endsBlock(opcode) || offset >= PAGE_SIZE) break;
+      }
+    }
+    // returns nullptr if the code at addr can't be decoded
+    const Block* findBlock(uint16_t addr) {
+      const uint8_t* page = ARS::board->read_pages[addr>>ARS::BUS_PAGE_SHIFT];
+      if(!page) return nullptr;
+      unsigned int offset = addr & ARS::BUS_PAGE_MASK;
+      uint32_t generation = generations[generationIndex(page)];
+      Block& block = blocks[blockIndex(page + offset)];
+      if(block.code != page + offset || block.epoch != epoch
+         || block.generation != generation)
+        decodeBlock(block, page, offset, generation);
+      return block.count ? &block : nullptr;
+    }
+    void runBlock(const Block& block) {
+      // (nothing the Core does can move us to another board)
+      ARS::MainBoard& board = *ARS::board;
+      uint16_t pc = core.read_pc();
+      cur_page = board.read_pages[pc >> ARS::BUS_PAGE_SHIFT];
+      const Instruction* instruction = block.instructions;
+      const Instruction* end = instruction + block.count;
+      while(true) {
+        // the opcode fetch, as ARS::read would have done it
+        --cycle_budget;
+        board.last_known_pc = pc;
+        core.write_pc(pc + 1);
+        core.execute(instruction->opcode);
+        pc += instruction->length;
+        if(!cur_page || core.read_pc() != pc || ++instruction == end
+           || cycle_budget <= 0 || !core.ready_for_opcode())
+          break;
+      }
+      cur_page = nullptr;
+    }
+  public:
+    CPU_Cached() : core(*this), blocks(new Block[BLOCK_CACHE_SIZE]()) {}
+    ~CPU_Cached() {}
+    void handleReset() override {
+      cycle_budget = 0;
+      audio_cycle_counter = 0;
+      ++epoch;
+      core.reset();
+    }
+    void eatCycles(int count) override {
+      cycle_budget -= count;
+    }
+    void runCycles(int count) override {
+      cycle_budget += count;
+      run_start_budget = cycle_budget;
+      while(core.in_productive_state() && cycle_budget > 0) {
+        const Block* block;
+        if(core.ready_for_opcode()
+           && (block = findBlock(core.read_pc())) != nullptr)
+          runBlock(*block);
+        else
+          core.step();
+      }
+      if(cycle_budget > 0) cycle_budget = 0;
+      ARS::run_apu(audio_cycle_counter, count);
+    }
+    int cyclesIntoRun() override {
+      return run_start_budget - cycle_budget;
+    }
+    void setIRQ(bool irq) override { core.set_irq(irq); }
+    void setSO(bool so) override { core.set_so(so); }
+    void setNMI(bool nmi) override { core.set_nmi(nmi); }
+    uint8_t read_byte(uint16_t addr, W65C02::ReadType) {
+      --cycle_budget;
+      return ARS::read(addr);
+    }
+    uint8_t read_opcode(uint16_t addr, W65C02::ReadType) {
+      --cycle_budget;
+      return ARS::read(addr, false, false, true);
+    }
+    uint8_t fetch_vector_byte(uint16_t addr) {
+      --cycle_budget;
+      return ARS::read(addr, false, true);
+    }
+    void write_byte(uint16_t addr, uint8_t byte, W65C02::WriteType) {
+      --cycle_budget;
+      ARS::write(addr, byte);
+      const uint8_t* page = ARS::board->read_pages[addr>>ARS::BUS_PAGE_SHIFT];
+      if(page) {
+        ++generations[generationIndex(page)];
+        if(page == cur_page) cur_page = nullptr;
+      }
+      else if((addr & 0xFFF8) == 0x0248) cur_page = nullptr;
+    }
+    bool isStopped() override {
+      return core.is_stopped();
+    }
+    template<class Archive> void transfer_state(Archive& ar) {
+      ar(cycle_budget);
+      ar(audio_cycle_counter);
+      core.transfer_state(ar);
+    }
+    void freeze(ARS::Freezer& f) override { transfer_state(f); }
+    void defrost(ARS::Defroster& d) override {
+      transfer_state(d);
+      // DRAM and cartridge RAM were replaced behind our back
+      ++epoch;
+    }
+  };
+}
+
+std::unique_ptr<ARS::CPU> ARS::makeCachedCPU(const std::string&) {
+  return std::make_unique<CPU_Cached>();
+}
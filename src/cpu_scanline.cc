@@ -14,7 +14,7 @@ namespace {
 #define makeScanlineCPU makeScanlineIntProfCPU
 #endif
   class CPU_Scanline : public ARS::CPU {
-    int cycle_budget = 0;
+    int cycle_budget = 0, run_start_budget = 0;
     uint32_t audio_cycle_counter = 0;
     W65C02::Core<CPU_Scanline> core;
 #if INTPROF
@@ -66,7 +66,7 @@ namespace {
     }
     void runCycles(int count) override {
       cycle_budget += count;
-      audio_cycle_counter += count;
+      run_start_budget = cycle_budget;
       while(core.in_productive_state() && cycle_budget > 0) {
         core.step();
       }
@@ -77,10 +77,10 @@ namespace {
 #endif
         cycle_budget = 0;
       }
-      while(audio_cycle_counter >= 256) {
-        audio_cycle_counter -= 256;
-        ARS::output_apu_sample();
-      }
+      ARS::run_apu(audio_cycle_counter, count);
+    }
+    int cyclesIntoRun() override {
+      return run_start_budget - cycle_budget;
     }
     void setIRQ(bool irq) override {
 #if INTPROF
@@ -146,6 +146,13 @@ namespace {
     bool isStopped() override {
       return core.is_stopped();
     }
+    template<class Archive> void transfer_state(Archive& ar) {
+      ar(cycle_budget);
+      ar(audio_cycle_counter);
+      core.transfer_state(ar);
+    }
+    void freeze(ARS::Freezer& f) override { transfer_state(f); }
+    void defrost(ARS::Defroster& d) override { transfer_state(d); }
 #if INTPROF
     void frameBoundary() override {
       if(counted_cycles > 0 && counted_cycles != state_cycles[WAI]) {
@@ -60,7 +60,7 @@ namespace std {
 
 namespace {
   class CPU_ScanlineDebug : public ARS::CPU {
-    int cycle_budget = 0;
+    int cycle_budget = 0, run_start_budget = 0;
     uint64_t cycle_count = 0;
     uint32_t audio_cycle_counter = 0;
     W65C02::Core<CPU_ScanlineDebug> core;
@@ -362,7 +362,7 @@ namespace {
     }
     void runCycles(int count) override {
       cycle_budget += count;
-      audio_cycle_counter += count;
+      run_start_budget = cycle_budget;
       while(core.in_productive_state() && cycle_budget > 0) {
         uint32_t mapped_pc = map_addr(core.read_pc(), false, false, true);
         if(!stopped) {
@@ -450,10 +450,10 @@ namespace {
         cycle_count += cycle_budget;
         cycle_budget = 0;
       }
-      while(audio_cycle_counter >= 256) {
-        audio_cycle_counter -= 256;
-        ARS::output_apu_sample();
-      }
+      ARS::run_apu(audio_cycle_counter, count);
+    }
+    int cyclesIntoRun() override {
+      return run_start_budget - cycle_budget;
     }
     void setIRQ(bool irq) override {
       if(trace_pins && this->irq != irq) {
@@ -607,6 +607,15 @@ namespace {
     bool isStopped() override {
       return core.is_stopped();
     }
+    template<class Archive> void transfer_state(Archive& ar) {
+      ar(cycle_budget);
+      ar(cycle_count);
+      ar(audio_cycle_counter);
+      ar(irq); ar(so); ar(nmi);
+      core.transfer_state(ar);
+    }
+    void freeze(ARS::Freezer& f) override { transfer_state(f); }
+    void defrost(ARS::Defroster& d) override { transfer_state(d); }
     uint8_t peek_byte(uint16_t addr) {
       return ARS::read(addr);
     }
@@ -1272,7 +1281,7 @@ namespace {
                   const std::vector<uint8_t>& target) {
     if(target.size() == 0 || (base_addr + target.size()) > 65536) return false;
     for(unsigned int n = 0; n < target.size(); ++n) {
-      if(ARS::cartridge->read(bank, base_addr+n) != target[n]) {
+      if(ARS::board->cartridge->read(bank, base_addr+n) != target[n]) {
         return false;
       }
     }
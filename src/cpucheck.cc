@@ -0,0 +1,350 @@
+#include "ars-emu.hh"
+#include "cpu.hh"
+#include "cartridge.hh"
+#include "expansions.hh"
+#include "configurator.hh"
+#include "ppu.hh"
+#include "apu.hh"
+#include "teg.hh"
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+/*
+
+  Runs the cached core and the fast core side by side, each on a board of
+  its own, and fails if they ever disagree: on how many cycles a run took,
+  on any register or pin, or on any byte of memory. They're fed the same
+  slices of cycles, the same interrupts and the same DMA stalls, in the
+  random sizes the PPU would hand them, are rewound now and then, and are
+  compared after every slice.
+
+  The cartridge has ROM in banks 0-7 and 4KiB of RAM, mirrored across every
+  other bank and every slot, so code can rewrite itself through a mirror.
+  The devices behind the registers are stubbed out, as in busbench.
+
+ */
+
+SN::Context sn;
+thread_local ARS::MessageImp ARS::ui;
+void ARS::MessageImp::outputBuffer() { stream.str(""); }
+
+__thread ARS::MainBoard* ARS::board;
+ARS::MainBoard::MainBoard() : dram() {}
+ARS::MainBoard::~MainBoard() {}
+
+// as the emulator has them, without -z or -C
+bool ARS::always_allow_config_port = false,
+  ARS::allow_secure_config_port = true;
+bool ARS::Configurator::is_active() { return false; }
+uint8_t ARS::PPU::complexRead(uint16_t) { return 0xBB; }
+void ARS::PPU::complexWrite(uint16_t, uint8_t) {}
+void ARS::write_apu(uint8_t, uint8_t) {}
+void ARS::run_apu(uint32_t& audio_cycle_counter, int count) {
+  audio_cycle_counter = (audio_cycle_counter + count) % 256;
+}
+
+namespace {
+  constexpr unsigned int ROM_BANK_COUNT = 8;
+  uint8_t rom[ROM_BANK_COUNT << 15];
+  uint8_t ram_image[0x1000];
+  uint8_t dram_image[0x8000];
+  uint8_t bank_map_image[8];
+  class TestCartridge : public ARS::Cartridge {
+  public:
+    uint8_t ram[sizeof(ram_image)];
+    TestCartridge() { memcpy(ram, ram_image, sizeof(ram)); }
+    static bool isROM(uint8_t bank) { return bank < ROM_BANK_COUNT; }
+    uint8_t read(uint8_t bank, uint16_t addr, bool, bool, bool) override {
+      if(isROM(bank)) return rom[(addr & 0x7FFF) | (bank << 15)];
+      else return ram[addr & 0xFFF];
+    }
+    void write(uint8_t bank, uint16_t addr, uint8_t value) override {
+      if(!isROM(bank)) ram[addr & 0xFFF] = value;
+    }
+    void oncePerFrame() override {}
+    // one slot per bank register
+    uint8_t getBS() override { return 3; }
+    const uint8_t* getReadPage(uint8_t bank, uint16_t addr) override {
+      addr &= ~ARS::BUS_PAGE_MASK;
+      if(isROM(bank)) return rom + ((addr & 0x7FFF) | (bank << 15));
+      else return ram + (addr & 0xFFF);
+    }
+  };
+  struct Side {
+    ARS::MainBoard board;
+    TestCartridge* cartridge;
+    std::vector<uint8_t> frozen;
+    // a snapshot, taken and restored the way a rewind would
+    std::vector<uint8_t> saved_cpu;
+    uint8_t saved_dram[sizeof(board.dram)];
+    uint8_t saved_ram[sizeof(ram_image)];
+    uint8_t saved_bank_map[sizeof(board.bankMap)];
+    Side(std::unique_ptr<ARS::CPU> cpu) {
+      ARS::board = &board;
+      memcpy(board.dram, dram_image, sizeof(board.dram));
+      memcpy(board.bankMap, bank_map_image, sizeof(board.bankMap));
+      board.cpu = std::move(cpu);
+      auto cartridge = std::make_unique<TestCartridge>();
+      this->cartridge = cartridge.get();
+      board.cartridge = std::move(cartridge);
+      ARS::rebuildPageTables();
+      board.cpu->handleReset();
+    }
+    void save() {
+      ARS::Freezer f(saved_cpu);
+      board.cpu->freeze(f);
+      memcpy(saved_dram, board.dram, sizeof(saved_dram));
+      memcpy(saved_ram, cartridge->ram, sizeof(saved_ram));
+      memcpy(saved_bank_map, board.bankMap, sizeof(saved_bank_map));
+    }
+    void restore() {
+      ARS::board = &board;
+      memcpy(board.dram, saved_dram, sizeof(saved_dram));
+      memcpy(cartridge->ram, saved_ram, sizeof(saved_ram));
+      memcpy(board.bankMap, saved_bank_map, sizeof(saved_bank_map));
+      ARS::rebuildPageTables();
+      ARS::Defroster d(saved_cpu.data(), saved_cpu.size());
+      board.cpu->defrost(d);
+    }
+  };
+  // describes the first difference between the two sides, or returns ""
+  std::string compare(Side& a, Side& b) {
+    for(auto side : {&a, &b}) {
+      ARS::Freezer f(side->frozen);
+      side->board.cpu->freeze(f);
+    }
+    // cycle budget, audio cycle counter, then the Core
+    if(a.frozen != b.frozen) return "CPU state";
+    for(unsigned int n = 0; n < sizeof(a.board.dram); ++n) {
+      if(a.board.dram[n] != b.board.dram[n])
+        return TEG::format("DRAM at $%04X", n);
+    }
+    if(memcmp(a.cartridge->ram, b.cartridge->ram, sizeof(a.cartridge->ram)))
+      return "cartridge RAM";
+    if(memcmp(a.board.bankMap, b.board.bankMap, sizeof(a.board.bankMap)))
+      return "bank map";
+    if(a.board.last_known_pc != b.board.last_known_pc) return "last known PC";
+    return "";
+  }
+  unsigned long cycles_per_test = 2000000;
+  unsigned long base_seed = 1;
+  // runs what's in the images on both cores; returns false if they differ
+  bool run(const std::string& name, unsigned long seed) {
+    Side fast(ARS::makeScanlineCPU(""));
+    Side cached(ARS::makeCachedCPU(""));
+    std::minstd_rand rng(seed);
+    unsigned long cycles = 0;
+    bool saved = false;
+    while(cycles < cycles_per_test) {
+      if(rng() % 64 == 0) {
+        fast.save();
+        cached.save();
+        saved = true;
+      }
+      else if(saved && rng() % 128 == 0) {
+        fast.restore();
+        cached.restore();
+      }
+      // a scanline's worth, give or take, with the odd DMA and interrupt
+      int count = 1 + rng() % (ARS::CYCLES_PER_SCANLINE * 2);
+      int eaten = rng() % 16 == 0 ? rng() % 300 : 0;
+      bool irq = rng() % 4 == 0, nmi = rng() % 32 == 0;
+      for(auto side : {&fast, &cached}) {
+        ARS::board = &side->board;
+        auto& cpu = *side->board.cpu;
+        if(eaten) cpu.eatCycles(eaten);
+        cpu.setIRQ(irq);
+        cpu.setNMI(nmi);
+        cpu.runCycles(count);
+      }
+      cycles += count;
+      auto difference = compare(fast, cached);
+      if(!difference.empty()) {
+        std::cout << "FAIL " << name << ": " << difference
+                  << " differs after " << cycles << " cycles\n";
+        return false;
+      }
+      if(fast.board.cpu->isStopped()) {
+        for(auto side : {&fast, &cached}) {
+          ARS::board = &side->board;
+          side->board.cpu->handleReset();
+        }
+      }
+    }
+    std::cout << "PASS " << name << "\n";
+    return true;
+  }
+  void poke(uint8_t bank, uint16_t addr, std::initializer_list<uint8_t> bytes){
+    for(auto byte : bytes) rom[((addr++) & 0x7FFF) | (bank << 15)] = byte;
+  }
+  // A loop that keeps rewriting code right before (and right as) it runs it:
+  // in DRAM, in cartridge RAM through a mirror, and by switching the bank of
+  // the slot it's running from.
+  bool selfModifyingCode() {
+    memset(rom, 0xDB, sizeof(rom)); // STP
+    memset(ram_image, 0xDB, sizeof(ram_image));
+    memset(dram_image, 0, sizeof(dram_image));
+    const uint8_t map[8] = {0, 1, 8, 9, 4, 5, 6, 7};
+    memcpy(bank_map_image, map, sizeof(map));
+    poke(7, 0xFFFA, {0x90, 0xF0, 0x00, 0xF0, 0x80, 0xF0});
+    poke(7, 0xF000, {
+        0xA2, 0xFF,       // LDX #$FF
+        0x9A,             // TXS
+        0xA0, 0x00,       // LDY #0
+        0xB9, 0x00, 0xF1, // LDA $F100,Y
+        0x99, 0x00, 0x04, // STA $0400,Y
+        0xB9, 0x00, 0xF2, // LDA $F200,Y
+        0x99, 0x00, 0x05, // STA $0500,Y
+        0xC8,             // INY
+        0xC0, 0x20,       // CPY #$20
+        0xD0, 0xEF,       // BNE $F005
+        0x58,             // CLI
+        0xEE, 0x01, 0x05, // INC $0501 (long before it runs, see below)
+        0x20, 0x00, 0x04, // JSR $0400
+        0xEE, 0x01, 0x04, // INC $0401
+        0xA5, 0x30,       // LDA $30
+        0x29, 0x07,       // AND #7
+        0x8D, 0x48, 0x02, // STA $0248
+        0x20, 0x00, 0x80, // JSR $8000
+        0x20, 0x00, 0x90, // JSR $9000
+        0xA9, 0xA9,       // LDA #$A9 (LDA #)
+        0x8D, 0x00, 0xA0, // STA $A000
+        0xA5, 0x30,       // LDA $30
+        0x8D, 0x01, 0xA0, // STA $A001
+        0xA9, 0x60,       // LDA #$60 (RTS)
+        0x8D, 0x02, 0xB0, // STA $B002 (the same RAM as $A002)
+        0x20, 0x00, 0xA0, // JSR $A000
+        0x85, 0x36,       // STA $36
+        0x20, 0x00, 0x05, // JSR $0500
+        0xE6, 0x30,       // INC $30
+        0x4C, 0x17, 0xF0, // JMP $F017
+      });
+    // IRQ and NMI handlers
+    poke(7, 0xF080, {0x48, 0xE6, 0x37, 0x68, 0x40}); // PHA INC PLA RTI
+    poke(7, 0xF090, {0xE6, 0x38, 0x40}); // INC RTI
+    // copied to $0400
+    poke(7, 0xF100, {
+        0xA9, 0x00,       // LDA #0 (bumped by the main loop)
+        0x8D, 0x07, 0x04, // STA $0407
+        0x18,             // CLC
+        0x69, 0x00,       // ADC #0 (patched by the STA above)
+        0x85, 0x31,       // STA $31
+        0x45, 0x32,       // EOR $32
+        0x85, 0x32,       // STA $32
+        0xAD, 0x16, 0x04, // LDA $0416
+        0x49, 0x22,       // EOR #$22
+        0x8D, 0x16, 0x04, // STA $0416
+        0xE8,             // INX (or DEX, every other time)
+        0x86, 0x33,       // STX $33
+        0x60,             // RTS
+      });
+    // copied to $0500; nothing else writes to its page, so a rewind that
+    // lands between the INC and the JSR finds it decoded with the wrong
+    // operand unless the defrost throws its blocks away
+    poke(7, 0xF200, {
+        0xA9, 0x00,       // LDA #0 (bumped by the main loop)
+        0x85, 0x39,       // STA $39
+        0x60,             // RTS
+      });
+    for(uint8_t bank = 0; bank < ROM_BANK_COUNT; ++bank) {
+      poke(bank, 0x8000, {
+          0xA9, bank,       // LDA #bank
+          0x18,             // CLC
+          0x65, 0x34,       // ADC $34
+          0x85, 0x34,       // STA $34
+          0x60,             // RTS
+        });
+      // switches out the bank it's running from, and carries on in the next
+      poke(bank, 0x9000, {
+          0xA9, uint8_t((bank + 1) % ROM_BANK_COUNT), // LDA #bank+1
+          0x8D, 0x49, 0x02, // STA $0249
+          0xA5, 0x35,       // LDA $35
+          0x69, bank,       // ADC #bank
+          0x85, 0x35,       // STA $35
+          0x60,             // RTS
+        });
+    }
+    return run("self-modifying code", base_seed);
+  }
+  // Random bytes everywhere, with plenty of bank switches and jumps into RAM
+  // mixed in.
+  bool randomCode(unsigned long seed) {
+    std::minstd_rand rng(seed);
+    for(auto& byte : rom) byte = rng();
+    for(auto& byte : ram_image) byte = rng();
+    for(auto& byte : dram_image) byte = rng();
+    for(auto& bank : bank_map_image) bank = rng() % (ROM_BANK_COUNT * 2);
+    for(unsigned int n = 0; n < sizeof(rom) / 64; ++n) {
+      uint32_t at = rng() % (sizeof(rom) - 3);
+      if(rng() % 2) {
+        // STA $0248-$024F
+        rom[at] = 0x8D; rom[at+1] = 0x48 | (rng() % 8); rom[at+2] = 0x02;
+      }
+      else {
+        // JMP somewhere in DRAM or cartridge RAM
+        uint16_t target = rng() % 2 ? rng() % 0x8000
+          : 0xA000 | (rng() % 0x2000);
+        rom[at] = 0x4C; rom[at+1] = target; rom[at+2] = target >> 8;
+      }
+    }
+    return run(TEG::format("random code (seed %lu)", seed), seed);
+  }
+  void print_usage() {
+    std::cout << "Usage: cpucheck [options]\n"
+      "Options:\n"
+      "-c: Number of cycles to run each test for, default is 2000000\n"
+      "-s: Seed for the random tests, default is 1\n"
+      "-n: Number of random tests, default is 8\n";
+  }
+  unsigned long random_test_count = 8;
+  bool parse_command_line(int argc, const char** argv) {
+    int n = 1;
+    bool valid = true;
+    while(n < argc) {
+      const char* arg = argv[n++];
+      if(arg[0] != '-') {
+        sn.Out(std::cerr, "UNKNOWN_OPTION"_Key, {arg});
+        valid = false;
+        continue;
+      }
+      ++arg;
+      while(*arg) {
+        char opt = *arg++;
+        switch(opt) {
+        case '?': print_usage(); return false;
+        case 'c': case 's': case 'n':
+          if(n >= argc) {
+            sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key,
+                   {std::string("-") + opt});
+            valid = false;
+          }
+          else {
+            unsigned long value = std::stoul(argv[n++]);
+            if(opt == 'c') cycles_per_test = value;
+            else if(opt == 's') base_seed = value;
+            else random_test_count = value;
+          }
+          break;
+        default:
+          sn.Out(std::cerr, "UNKNOWN_OPTION"_Key, {std::string(arg-1,1)});
+          valid = false;
+        }
+      }
+    }
+    if(!valid) {
+      print_usage();
+      return false;
+    }
+    return true;
+  }
+}
+
+extern "C" int teg_main(int argc, char** argv) {
+  if(!parse_command_line(argc, const_cast<const char**>(argv))) return 1;
+  bool ok = selfModifyingCode();
+  for(unsigned long n = 0; n < random_test_count; ++n)
+    ok = randomCode(base_seed + n) && ok;
+  return ok ? 0 : 1;
+}
@@ -103,6 +103,12 @@ namespace {
         mem->write(real_addr, value);
     }
     void handleReset() override {}
+    const uint8_t* getReadPage(uint8_t bank, uint16_t addr) override {
+      ARS::Memory* mem = nullptr;
+      // bs is at most 3, so an unshifted window is never smaller than a page
+      uint32_t real_addr = map_addr(mem, bank, addr, false, false, false);
+      return mem ? mem->getPage(real_addr) : nullptr;
+    }
     uint8_t getPowerOnBank() override {
       return power_on_bank;
     }
@@ -114,6 +120,16 @@ namespace {
         if(p) p->oncePerFrame();
       }
     }
+    void freeze(ARS::Freezer& f) override {
+      for(auto& p : memory_storage) {
+        if(p) p->freeze(f);
+      }
+    }
+    void defrost(ARS::Defroster& d) override {
+      for(auto& p : memory_storage) {
+        if(p) p->defrost(d);
+      }
+    }
   };
 }
 
@@ -5,7 +5,9 @@
 
 #include <assert.h>
 #include "upscale.hh"
+#include "fx.hh"
 #include "menu.hh"
+#include "presenter.hh"
 
 namespace {
   template<class T> constexpr T clamp(T value, T min, T max) {
@@ -17,10 +19,14 @@ namespace {
   bool enable_overscan;
   int signal_type;
   int upscale_type;
+  FX::TVControls tv_controls;
   const Config::Element elements[] = {
     {"signal_type", *reinterpret_cast<int*>(&signal_type)},
     {"upscale_type", *reinterpret_cast<int*>(&upscale_type)},
     {"enable_overscan", enable_overscan},
+    {"tv_hue", tv_controls.hue},
+    {"tv_saturation", tv_controls.saturation},
+    {"tv_sharpness", tv_controls.sharpness},
   };
   class DisplaySystemPrefsLogic : public PrefsLogic {
   protected:
@@ -29,6 +35,9 @@ namespace {
                    elements, elementcount(elements));
       signal_type = clamp(signal_type, 0, MAX_SIGNAL_TYPE);
       upscale_type = clamp(upscale_type, 0, MAX_UPSCALE_TYPE);
+      tv_controls.hue = clamp(tv_controls.hue, -180.f, 180.f);
+      tv_controls.saturation = clamp(tv_controls.saturation, 0.f, 2.f);
+      tv_controls.sharpness = clamp(tv_controls.sharpness, -1.f, 1.f);
     }
     void Save() override {
       Config::Write("SDL Display.utxt",
@@ -38,6 +47,7 @@ namespace {
       enable_overscan = true;
       signal_type = static_cast<int>(SignalType::RGB);
       upscale_type = static_cast<int>(UpscaleType::SCANLINES_BRIGHT);
+      tv_controls = FX::TVControls();
     }
   } displaySystemPrefsLogic;
   class SDLDisplay : public ARS::Display {
@@ -56,6 +66,11 @@ namespace {
     // left/rightrect: repeat the left/right column of the screen
     // top/botrect: black out
     SDL_Rect dstrect, leftrect, rightrect, toprect, botrect;
+    // runs the upscaler one frame behind emulation, on its own thread (or
+    // right away, on this one, without FX threads); the texture upload and
+    // present have to stay on this one, since that's the thread that made
+    // the renderer
+    std::unique_ptr<ARS::Presenter> presenter;
   public:
     SDLDisplay() {
       if(enable_overscan) {
@@ -77,6 +92,8 @@ namespace {
                           upscaled_width, upscaled_height,
                           output_left, output_top,
                           output_right, output_bottom);
+      // (the old display's presenter, and so its FX calls, are gone by now)
+      FX::setTVControls(tv_controls);
       SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY,
                   upscaler.shouldSmoothResult() ? "linear" : "nearest");
       unsigned int display_width, display_height;
@@ -117,10 +134,17 @@ namespace {
       if(frametexture == NULL) throw sn.Get("FRAMETEXTURE_FAIL"_Key,
                                             {SDL_GetError()});
       resize();
+      presenter = std::make_unique<ARS::Presenter>
+        (upscaled_width * upscaled_height * 4,
+         [this](const ARS::PPU::raw_screen& in, uint8_t* out) {
+          upscaler.apply(in, out);
+        });
       we_are_active = true;
     }
     ~SDLDisplay() {
       we_are_active = false;
+      // must go first; its thread is still using the upscaler
+      presenter.reset();
       if(frametexture != nullptr) {
         SDL_DestroyTexture(frametexture);
         frametexture = nullptr;
@@ -138,13 +162,12 @@ namespace {
       return window;
     }
     void update(const ARS::PPU::raw_screen& src) override {
-      uint8_t* pixels;
-      int pitch;
-      SDL_LockTexture(frametexture, nullptr,
-                      reinterpret_cast<void**>(&pixels), &pitch);
-      assert(static_cast<unsigned int>(pitch) == upscaled_width * 4);
-      upscaler.apply(src, pixels);
-      SDL_UnlockTexture(frametexture);
+      presenter->submit(src);
+      // if the presenter hasn't finished a new frame yet, show the last one
+      // again rather than skipping the present, so that vsync still paces us
+      const uint8_t* pixels = presenter->takePrepared();
+      if(pixels != nullptr)
+        SDL_UpdateTexture(frametexture, nullptr, pixels, upscaled_width * 4);
       SDL_RenderClear(renderer);
       SDL_Rect srcrect;
       srcrect.x = output_left;
@@ -7,30 +7,28 @@ using namespace ARS;
 
 bool ARS::always_allow_config_port = false,
   ARS::allow_secure_config_port = true,
-  ARS::secure_config_port_checked = false,
   ARS::allow_debug_port = false,
   ARS::mapped_debug_port = false;
 std::unique_ptr<std::ostream> ARS::debug_port_file = nullptr;
-std::unique_ptr<ARS::Expansion> ARS::expansions[8];
 
 namespace {
   bool config_port_access_is_secure(uint16_t pc) {
     return pc >= 0xF000 && pc <= 0xF7FF;
   }
-  bool secure_config_port_available;
   class ConfigPort : public ARS::Expansion {
+    bool secure_config_port_available = false;
   public:
     void output(uint8_t value) override {
       if(always_allow_config_port)
         return Configurator::write(value);
       else if(allow_secure_config_port) {
-        if(!secure_config_port_checked) {
-          secure_config_port_checked = true;
+        if(!board->secure_config_port_checked) {
+          board->secure_config_port_checked = true;
           secure_config_port_available
             = Configurator::is_secure_configurator_present();
         }
         if(secure_config_port_available) {
-          if(config_port_access_is_secure(last_known_pc))
+          if(config_port_access_is_secure(board->last_known_pc))
             return Configurator::write(value);
         }
       }
@@ -39,13 +37,13 @@ namespace {
       if(always_allow_config_port)
         return Configurator::read();
       else if(allow_secure_config_port) {
-        if(!secure_config_port_checked) {
-          secure_config_port_checked = true;
+        if(!board->secure_config_port_checked) {
+          board->secure_config_port_checked = true;
           secure_config_port_available
             = Configurator::is_secure_configurator_present();
         }
         if(secure_config_port_available) {
-          if(config_port_access_is_secure(last_known_pc))
+          if(config_port_access_is_secure(board->last_known_pc))
             return Configurator::read();
           else
             return 0xEC;
@@ -62,8 +60,8 @@ namespace {
         std::cerr << value;
     }
     uint8_t input() override {
-      cpu->setSO(true);
-      cpu->setSO(false);
+      board->cpu->setSO(true);
+      board->cpu->setSO(false);
       return 0xFF;
     }
   public:
@@ -104,13 +102,14 @@ void ARS::map_expansion(uint16_t addr, const std::string& type) {
 void ARS::map_expansion(uint16_t addr, std::unique_ptr<Expansion> p) {
   if(addr < 0x240 || addr > 0x247)
     die("INTERNAL ERROR: Expansion IO address out of range");
-  if(expansions[addr&7])
+  auto& slot = board->expansions[addr&7];
+  if(slot)
     throw sn.Get("BOARD_EXPANSION_ADDRESS_CONFLICT"_Key);
-  expansions[addr&7] = std::move(p);
+  slot = std::move(p);
 }
 
 void ARS::tell_expansions_about_frame() {
-  for(auto&& expansion : expansions) {
+  for(auto&& expansion : board->expansions) {
     if(expansion) expansion->on_frame();
   }
 }
@@ -758,8 +758,8 @@ namespace {
     }
     void output_cmd(uint8_t value) {
       if(response_buf.size() > 0) {
-        cpu->setSO(true);
-        cpu->setSO(false);
+        board->cpu->setSO(true);
+        board->cpu->setSO(false);
       }
       else if(value == 0) {
         // abort any in-progress command line
@@ -815,8 +815,8 @@ namespace {
     }
     uint8_t input() override {
       if((!fast_floppy_mode && delay_response > 0) || command_buf_pos > 0) {
-        cpu->setSO(true);
-        cpu->setSO(false);
+        board->cpu->setSO(true);
+        board->cpu->setSO(false);
         return 0xFF;
       }
       else if(response_buf_pos < response_buf.size()) {
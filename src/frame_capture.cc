@@ -0,0 +1,196 @@
+#include "frame_capture.hh"
+#include "fxinternal.hh"
+#include "io.hh"
+
+#include <atomic>
+
+using namespace ARS;
+
+namespace {
+  const char MAGIC[8] = {'A','R','S','V','I','D','E','O'};
+  constexpr uint8_t VERSION = 1;
+  constexpr size_t FRAME_SIZE = sizeof(PPU::raw_screen);
+  static_assert(FRAME_SIZE == PPU::TOTAL_SCREEN_WIDTH
+                * PPU::TOTAL_SCREEN_HEIGHT,
+                "raw_screen has padding; frames won't be contiguous");
+  // about a second; the writer only falls this far behind if the disk stalls
+  constexpr size_t POOL_FRAMES = 64;
+  // ten seconds
+  constexpr unsigned int KEY_FRAME_INTERVAL = 600;
+  PPU::raw_screen pool[POOL_FRAMES];
+  // how many times to repeat the previous frame before pool[n]
+  uint32_t repeats_before[POOL_FRAMES];
+  // frame counts since start, never wrapped
+  std::atomic<size_t> write_pos, read_pos;
+  // emulation thread's
+  uint32_t pending_repeats;
+  uint64_t dropped_frames;
+  std::atomic<bool> active{false}, stopping;
+  std::unique_ptr<std::ostream> out;
+  std::string out_path;
+  SDL_sem* wake;
+  SDL_Thread* writer;
+  // writer thread's
+  PPU::raw_screen prev_frame;
+  uint8_t delta[FRAME_SIZE];
+  std::vector<uint8_t> packed;
+  unsigned int frames_since_key;
+  // Apple's PackBits, as in TIFF: a header byte of 0-127 is followed by that
+  // many plus one literal bytes, 129-255 is followed by one byte to repeat
+  // 257 minus that many times
+  void packBits(const uint8_t* in, size_t len) {
+    packed.clear();
+    size_t n = 0;
+    while(n < len) {
+      size_t run = 1;
+      while(n + run < len && run < 128 && in[n + run] == in[n]) ++run;
+      if(run >= 2) {
+        packed.push_back(static_cast<uint8_t>(257 - run));
+        packed.push_back(in[n]);
+        n += run;
+      }
+      else {
+        size_t start = n;
+        while(n < len && n - start < 128
+              && !(n + 1 < len && in[n] == in[n + 1]))
+          ++n;
+        packed.push_back(static_cast<uint8_t>(n - start - 1));
+        packed.insert(packed.end(), in + start, in + n);
+      }
+    }
+  }
+  void writeRecord(char type, const std::vector<uint8_t>* payload) {
+    out->put(type);
+    if(payload == nullptr) return;
+    uint8_t length[4];
+    for(int n = 0; n < 4; ++n) length[n] = payload->size() >> (n * 8);
+    out->write(reinterpret_cast<const char*>(length), sizeof(length));
+    out->write(reinterpret_cast<const char*>(payload->data()),
+               payload->size());
+  }
+  void writeRepeats(uint32_t count) {
+    while(count-- > 0) {
+      writeRecord('R', nullptr);
+      ++frames_since_key;
+    }
+  }
+  void writeFrame(const PPU::raw_screen& frame) {
+    auto in = reinterpret_cast<const uint8_t*>(frame.data());
+    auto prev = reinterpret_cast<const uint8_t*>(prev_frame.data());
+    if(frames_since_key >= KEY_FRAME_INTERVAL) {
+      packBits(in, FRAME_SIZE);
+      writeRecord('K', &packed);
+      frames_since_key = 0;
+    }
+    else if(!memcmp(in, prev, FRAME_SIZE)) {
+      writeRepeats(1);
+      return;
+    }
+    else {
+      for(size_t n = 0; n < FRAME_SIZE; ++n) delta[n] = in[n] ^ prev[n];
+      packBits(delta, FRAME_SIZE);
+      writeRecord('D', &packed);
+    }
+    ++frames_since_key;
+    prev_frame = frame;
+  }
+  int writer_body(void*) {
+    while(true) {
+      bool last = stopping;
+      size_t rd = read_pos.load(std::memory_order_relaxed);
+      size_t wr = write_pos.load(std::memory_order_acquire);
+      while(rd != wr) {
+        writeRepeats(repeats_before[rd % POOL_FRAMES]);
+        writeFrame(pool[rd % POOL_FRAMES]);
+        read_pos.store(++rd, std::memory_order_release);
+      }
+      if(last) break;
+      SDL_SemWait(wake);
+    }
+    return 0;
+  }
+}
+
+bool FrameCapture::start(const std::string& path) {
+  stop();
+  out = IO::OpenRawPathForWrite(path);
+  if(!out || !*out) {
+    sn.Out(std::cout, "FRAME_CAPTURE_FAILED_TO_OPEN"_Key, {path});
+    out.reset();
+    return false;
+  }
+  out_path = path;
+  uint8_t header[sizeof(MAGIC) + 5 + 256 * 3];
+  memcpy(header, MAGIC, sizeof(MAGIC));
+  header[8] = VERSION;
+  header[9] = PPU::TOTAL_SCREEN_WIDTH & 255;
+  header[10] = PPU::TOTAL_SCREEN_WIDTH >> 8;
+  header[11] = PPU::TOTAL_SCREEN_HEIGHT & 255;
+  header[12] = PPU::TOTAL_SCREEN_HEIGHT >> 8;
+  for(int n = 0; n < 256; ++n) {
+    header[13 + n * 3] = (FX::hardwarePalette[n] >> 16) & 255;
+    header[14 + n * 3] = (FX::hardwarePalette[n] >> 8) & 255;
+    header[15 + n * 3] = FX::hardwarePalette[n] & 255;
+  }
+  out->write(reinterpret_cast<const char*>(header), sizeof(header));
+  write_pos = 0;
+  read_pos = 0;
+  pending_repeats = 0;
+  dropped_frames = 0;
+  // repeats before the first frame repeat black, and the first frame is a
+  // key frame
+  memset(prev_frame.data(), 0, FRAME_SIZE);
+  frames_since_key = KEY_FRAME_INTERVAL;
+  stopping = false;
+  wake = SDL_CreateSemaphore(0);
+  if(wake == nullptr)
+    die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+  writer = SDL_CreateThread(writer_body, "frame capture", nullptr);
+  if(writer == nullptr)
+    die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+  active = true;
+  return true;
+}
+
+void FrameCapture::stop() {
+  if(!active) return;
+  active = false;
+  stopping = true;
+  SDL_SemPost(wake);
+  SDL_WaitThread(writer, nullptr);
+  SDL_DestroySemaphore(wake);
+  writeRepeats(pending_repeats);
+  out->flush();
+  if(!*out)
+    sn.Out(std::cerr, "FRAME_CAPTURE_WRITE_FAILED"_Key, {out_path});
+  out.reset();
+  if(dropped_frames > 0)
+    sn.Out(std::cerr, "FRAME_CAPTURE_DROPPED_FRAMES"_Key,
+           {TEG::format("%llu", (unsigned long long)dropped_frames)});
+}
+
+bool FrameCapture::isActive() {
+  return active.load(std::memory_order_relaxed);
+}
+
+void FrameCapture::push(const PPU::raw_screen& frame, bool wait) {
+  if(!isActive()) return;
+  size_t wr = write_pos.load(std::memory_order_relaxed);
+  while(wr - read_pos.load(std::memory_order_acquire) >= POOL_FRAMES) {
+    if(!wait) {
+      ++dropped_frames;
+      ++pending_repeats;
+      return;
+    }
+    SDL_Delay(1);
+  }
+  pool[wr % POOL_FRAMES] = frame;
+  repeats_before[wr % POOL_FRAMES] = pending_repeats;
+  pending_repeats = 0;
+  write_pos.store(wr + 1, std::memory_order_release);
+  SDL_SemPost(wake);
+}
+
+void FrameCapture::skip() {
+  if(isActive()) ++pending_repeats;
+}
@@ -5,114 +5,118 @@
 #include <assert.h>
 
 #include <cmath>
+#include <atomic>
+#include <thread>
 
 #include "fxtables.hh"
 
 using namespace FX;
 
 namespace {
-  class Worker {
-    Worker(const Worker&) = delete;
-    Worker(Worker&&) = delete;
-    Worker& operator=(const Worker&) = delete;
-    Worker& operator=(Worker&&) = delete;
-    std::function<void(unsigned int, unsigned int)> task = nullptr;
-    unsigned int start, stop;
-    static Worker* worker_threads;
-    static unsigned int thread_count;
-    static SDL_threadID main_thread;
-    SDL_mutex* lock;
-    SDL_cond* cond;
-    int body() {
-      SDL_LockMutex(lock);
-      while(true) {
-        while(task == nullptr) {
-          SDL_CondWait(cond, lock);
-        }
-        task(start, stop);
-        task = nullptr;
-      }
-      SDL_UnlockMutex(lock);
-      // NOTREACHED
-      std::cerr <<"INTERNAL ERROR: FX worker thread terminated prematurely!\n";
-      return 0;
-    }
-    static int outer_body(void*p){return reinterpret_cast<Worker*>(p)->body();}
-  public:
-    Worker() {
-      static unsigned int num_workers_so_far = 0;
-      cond = SDL_CreateCond();
-      assert(cond);
-      lock = SDL_CreateMutex();
-      assert(lock);
-      std::ostringstream str;
-      str << "" << (++num_workers_so_far);
-      std::string name = str.str();
-      SDL_Thread* thread = SDL_CreateThread(outer_body, name.c_str(), this);
-      if(thread == nullptr) {
-        std::string why = sn.Get("THREAD_CREATION_ERROR"_Key,
-                                 {SDL_GetError()});
-        die("%s", why.c_str());
-      }
-      SDL_DetachThread(thread);
-    }
-    ~Worker() {
-      std::cerr << "BUG: Worker destructor called!\n";
+  // rows are handed out to threads this many at a time
+  constexpr unsigned int BAND_ROWS = 8;
+  // composite_bgra and svideo_bgra alternate chroma phase by row number
+  // within the rows they're given
+  static_assert(BAND_ROWS % 2 == 0, "BAND_ROWS must be even");
+  /* One FX operation, split into bands of rows. Each band can run on any
+     thread. */
+  struct Job {
+    const std::function<void(unsigned int, unsigned int)> task;
+    const unsigned int rows, num_bands;
+    std::atomic<unsigned int> next_band;
+    std::atomic<unsigned int> bands_left;
+    Job(std::function<void(unsigned int, unsigned int)> task,
+        unsigned int rows)
+      : task(std::move(task)), rows(rows),
+        num_bands((rows+BAND_ROWS-1)/BAND_ROWS), next_band(0),
+        bands_left(num_bands) {}
+  };
+  unsigned int thread_count = 0;
+  // the thread whose FX calls are split up among the workers
+  std::atomic<SDL_threadID> main_thread;
+  SDL_sem* wake;
+  SDL_sem* job_finished;
+  // the job being run, if any, and how many workers might be looking at it
+  std::atomic<Job*> current_job{nullptr};
+  std::atomic<unsigned int> job_users{0};
+  // Claims and runs bands until they're all claimed.
+  void helpWithJob(Job& job) {
+    unsigned int band;
+    while((band = job.next_band++) < job.num_bands) {
+      unsigned int start = band * BAND_ROWS;
+      unsigned int stop = std::min(start + BAND_ROWS, job.rows);
+      job.task(start, stop);
+      if(--job.bands_left == 0) SDL_SemPost(job_finished);
     }
-    static void performTask(std::function<void(unsigned int,
-                                               unsigned int)> task,
-                            unsigned int big_start, unsigned int big_stop) {
-      if(thread_count == 1 || SDL_ThreadID() != main_thread) {
-        task(big_start, big_stop);
-        return;
-      }
-      else {
-        unsigned int big_size = big_stop - big_start;
-        unsigned int start = 0;
-        for(unsigned int i = 0; i < thread_count-1; ++i) {
-          unsigned int stop = (i+1) * big_size / thread_count;
-          if(stop != start) {
-            // the mutex may provide a memory barrier
-            SDL_LockMutex(worker_threads[i].lock);
-            worker_threads[i].task = task;
-            worker_threads[i].start = start;
-            worker_threads[i].stop = stop;
-            SDL_UnlockMutex(worker_threads[i].lock);
-            SDL_CondBroadcast(worker_threads[i].cond);
-            start = stop;
-          }
-        }
-        if(start != big_stop) task(start, big_stop);
-        // wait for each worker to complete before continuing
-        for(unsigned int i = 0; i < thread_count-1; ++i) {
-          SDL_LockMutex(worker_threads[i].lock);
-          SDL_UnlockMutex(worker_threads[i].lock);
-        }
-      }
+  }
+  int worker_body(void*) {
+    while(true) {
+      SDL_SemWait(wake);
+      // (announce ourselves before looking, so that runJob can't retire the
+      // job between our looking and our announcing)
+      ++job_users;
+      Job* job = current_job;
+      if(job != nullptr) helpWithJob(*job);
+      --job_users;
     }
-    static void init(unsigned int thread_count) {
-      if(Worker::thread_count != 0) {
-        die("INTERNAL ERROR: init called more than once");
-      }
-      Worker::thread_count = thread_count;
-      main_thread = SDL_ThreadID();
-      worker_threads = new Worker[thread_count-1];
+    // NOTREACHED
+    return 0;
+  }
+  void runJob(Job& job) {
+    if(job.num_bands == 0) return;
+    current_job = &job;
+    for(unsigned int n = 0; n < thread_count-1; ++n) SDL_SemPost(wake);
+    helpWithJob(job);
+    SDL_SemWait(job_finished);
+    current_job = nullptr;
+    while(job_users != 0) std::this_thread::yield();
+  }
+  bool canSplit() {
+    return thread_count > 1 && SDL_ThreadID() == main_thread;
+  }
+  // task may be given up to BAND_ROWS rows at a time, or all of them at once
+  void performTask(std::function<void(unsigned int, unsigned int)> task,
+                   unsigned int rows) {
+    if(!canSplit()) {
+      task(0, rows);
+      return;
     }
-  };
-  Worker* Worker::worker_threads;
-  unsigned int Worker::thread_count = 0;
-  SDL_threadID Worker::main_thread;
+    Job job(std::move(task), rows);
+    runJob(job);
+  }
 }
 
 void FX::init(unsigned int init_thread_count) {
-  unsigned int thread_count;
+  if(thread_count != 0) {
+    die("INTERNAL ERROR: init called more than once");
+  }
   if(init_thread_count == 0) {
     int threads = SDL_GetCPUCount();
     if(threads < 1) thread_count = 1;
     else thread_count = threads;
   }
   else thread_count = init_thread_count;
-  Worker::init(thread_count);
+  main_thread = SDL_ThreadID();
+  if(thread_count == 1) return;
+  wake = SDL_CreateSemaphore(0);
+  job_finished = SDL_CreateSemaphore(0);
+  if(wake == nullptr || job_finished == nullptr)
+    die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+  for(unsigned int n = 1; n < thread_count; ++n) {
+    std::string name = TEG::format("FX %u", n);
+    SDL_Thread* thread = SDL_CreateThread(worker_body, name.c_str(), nullptr);
+    if(thread == nullptr)
+      die("%s", sn.Get("THREAD_CREATION_ERROR"_Key, {SDL_GetError()}).c_str());
+    SDL_DetachThread(thread);
+  }
+}
+
+unsigned int FX::getThreadCount() {
+  return thread_count == 0 ? 1 : thread_count;
+}
+
+void FX::adoptCurrentThread() {
+  main_thread = SDL_ThreadID();
 }
 
 const Linearize& FX::linearizer() {
@@ -125,13 +129,177 @@ const Delinearize& FX::delinearizer() {
   return delinearize;
 }
 
+FX::IndexedFIR::IndexedFIR(const TVFIR& fir)
+  : radius(fir.radius), num_taps(fir.num_taps) {
+  uint32_t slot_colors[256];
+  num_slots = 1;
+  for(int n = 0; n < 256; ++n) {
+    uint32_t color = hardwarePalette[n] & 0xFFFFFF;
+    unsigned int slot = 1;
+    while(slot < num_slots && slot_colors[slot] != color) ++slot;
+    if(slot == num_slots) slot_colors[num_slots++] = color;
+    slots[n] = slot;
+  }
+  table.resize(NUM_CHROMA_PHASES * num_taps * num_slots * NUM_TV_SUBPIXELS);
+  auto out = table.begin();
+  for(int phase = 0; phase < NUM_CHROMA_PHASES; ++phase) {
+    for(int tap = 0; tap < num_taps; ++tap) {
+      for(unsigned int slot = 0; slot < num_slots; ++slot) {
+        int32_t in_r = (slot_colors[slot] >> 16) & 255;
+        int32_t in_g = (slot_colors[slot] >> 8) & 255;
+        int32_t in_b = slot_colors[slot] & 255;
+        if(slot == 0) in_r = in_g = in_b = 0;
+        for(int subpixel = 0; subpixel < NUM_TV_SUBPIXELS; ++subpixel) {
+          const int32_t* coefs = fir.get(phase, subpixel) + tap * 9;
+          Contribution& c = *out++;
+          c.red = in_r * coefs[0] + in_g * coefs[3] + in_b * coefs[6];
+          c.green = in_r * coefs[1] + in_g * coefs[4] + in_b * coefs[7];
+          c.blue = in_r * coefs[2] + in_g * coefs[5] + in_b * coefs[8];
+          c.unused = 0;
+        }
+      }
+    }
+  }
+}
+
+constexpr int FX::VectorFIR::TAP_SIZE;
+
+FX::VectorFIR::VectorFIR(const TVFIR& fir)
+  : radius(fir.radius), num_taps(fir.num_taps) {
+  // input channels, in the order they're paired up; 3 is alpha
+  static const int pairs[2][2] = {{2, 1}, {0, 3}};
+  table.reserve(NUM_CHROMA_PHASES * num_taps * TAP_SIZE);
+  for(int phase = 0; phase < NUM_CHROMA_PHASES; ++phase) {
+    for(int tap = 0; tap < num_taps; ++tap) {
+      for(int part = 0; part < 2; ++part) {
+        for(int pair = 0; pair < 2; ++pair) {
+          for(int subpixel = 0; subpixel < NUM_TV_SUBPIXELS; ++subpixel) {
+            const int32_t* coefs = fir.get(phase, subpixel) + tap * 9;
+            // output blue, green, red, alpha
+            for(int out_channel = 2; out_channel >= -1; --out_channel) {
+              for(int in_channel : pairs[pair]) {
+                int32_t coef = 0;
+                if(in_channel < 3 && out_channel >= 0)
+                  coef = coefs[in_channel * 3 + out_channel];
+                table.push_back(part == 0 ? coef >> 8 : coef & 255);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+namespace {
+  FX::TVControls tv_controls;
+  // everything made from the TV controls, for one kind of signal
+  struct TVFilters {
+    const TVFIR fir;
+    const IndexedFIR indexed;
+    const VectorFIR vector;
+    explicit TVFilters(bool composite)
+      : fir(composite, tv_controls), indexed(fir), vector(fir) {}
+  };
+  std::unique_ptr<TVFilters> composite_filters, svideo_filters;
+  // Called by each FX call that needs them, on the calling thread, before
+  // any implementation (which might be on another thread) uses them.
+  void makeCompositeFilters() {
+    if(!composite_filters)
+      composite_filters = std::make_unique<TVFilters>(true);
+  }
+  void makeSVideoFilters() {
+    if(!svideo_filters)
+      svideo_filters = std::make_unique<TVFilters>(false);
+  }
+}
+
+void FX::setTVControls(const TVControls& controls) {
+  if(controls.hue == tv_controls.hue
+     && controls.saturation == tv_controls.saturation
+     && controls.sharpness == tv_controls.sharpness) return;
+  tv_controls = controls;
+  composite_filters.reset();
+  svideo_filters.reset();
+}
+
+const TVFIR& FX::compositeFIR() {
+  return composite_filters->fir;
+}
+
+const TVFIR& FX::svideoFIR() {
+  return svideo_filters->fir;
+}
+
+const IndexedFIR& FX::compositeIndexedFIR() {
+  return composite_filters->indexed;
+}
+
+const IndexedFIR& FX::svideoIndexedFIR() {
+  return svideo_filters->indexed;
+}
+
+const VectorFIR& FX::compositeVectorFIR() {
+  return composite_filters->vector;
+}
+
+const VectorFIR& FX::svideoVectorFIR() {
+  return svideo_filters->vector;
+}
+
 void FX::raw_screen_to_bgra(const ARS::PPU::raw_screen& in,
                             void* out,
                             unsigned int left, unsigned int top,
                             unsigned int right, unsigned int bottom,
                             bool output_skips_rows) {
   static auto best_imp = FX::Imp::raw_screen_to_bgra().best([&](FX::Proto::raw_screen_to_bgra candidate) { candidate(in, out, left, top, right, bottom, output_skips_rows); });
-  best_imp(in, out, left, top, right, bottom, output_skips_rows);
+  performTask([=,&in](unsigned int start, unsigned int stop) {
+      void* local_out = reinterpret_cast<uint8_t*>(out)
+        +start*(right-left)*4*(output_skips_rows?2:1);
+      best_imp(in, local_out, left, top+start, right, top+stop,
+               output_skips_rows);
+    }, bottom-top);
+}
+
+namespace {
+  // These pick the best implementation, by trying each on the first call's
+  // arguments, for operations that are also used by filter_with_scanlines.
+  FX::Proto::raw_screen_to_bgra_2x
+  best_raw_screen_to_bgra_2x(const ARS::PPU::raw_screen& in, void* out,
+                             unsigned int left, unsigned int top,
+                             unsigned int right, unsigned int bottom,
+                             bool output_skips_rows) {
+    static auto best_imp = FX::Imp::raw_screen_to_bgra_2x().best([&](FX::Proto::raw_screen_to_bgra_2x candidate) { candidate(in, out, left, top, right, bottom, output_skips_rows); });
+    return best_imp;
+  }
+  FX::Proto::composite_raw_screen
+  best_composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                            unsigned int left, unsigned int top,
+                            unsigned int right, unsigned int bottom,
+                            bool output_skips_rows) {
+    static auto best_imp = FX::Imp::composite_raw_screen().best([&](FX::Proto::composite_raw_screen candidate) { candidate(in, out, left, top, right, bottom, output_skips_rows); });
+    return best_imp;
+  }
+  FX::Proto::svideo_raw_screen
+  best_svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                         unsigned int left, unsigned int top,
+                         unsigned int right, unsigned int bottom,
+                         bool output_skips_rows) {
+    static auto best_imp = FX::Imp::svideo_raw_screen().best([&](FX::Proto::svideo_raw_screen candidate) { candidate(in, out, left, top, right, bottom, output_skips_rows); });
+    return best_imp;
+  }
+  FX::Proto::scanline_crisp_bgra
+  best_scanline_crisp_bgra(void* buf, unsigned int width,
+                           unsigned int height) {
+    static auto best_imp = FX::Imp::scanline_crisp_bgra().best([&](FX::Proto::scanline_crisp_bgra candidate) { candidate(buf, width, height); });
+    return best_imp;
+  }
+  FX::Proto::scanline_bright_bgra
+  best_scanline_bright_bgra(void* buf, unsigned int width,
+                            unsigned int height) {
+    static auto best_imp = FX::Imp::scanline_bright_bgra().best([&](FX::Proto::scanline_bright_bgra candidate) { candidate(buf, width, height); });
+    return best_imp;
+  }
 }
 
 void FX::raw_screen_to_bgra_2x(const ARS::PPU::raw_screen& in,
@@ -139,52 +307,143 @@ void FX::raw_screen_to_bgra_2x(const ARS::PPU::raw_screen& in,
                                unsigned int left, unsigned int top,
                                unsigned int right, unsigned int bottom,
                                bool output_skips_rows) {
-  static auto best_imp = FX::Imp::raw_screen_to_bgra_2x().best([&](FX::Proto::raw_screen_to_bgra_2x candidate) { candidate(in, out, left, top, right, bottom, output_skips_rows); });
-  best_imp(in, out, left, top, right, bottom, output_skips_rows);
+  auto best_imp = best_raw_screen_to_bgra_2x(in, out, left, top, right,
+                                             bottom, output_skips_rows);
+  performTask([=,&in](unsigned int start, unsigned int stop) {
+      void* local_out = reinterpret_cast<uint8_t*>(out)
+        +start*(right-left)*8*(output_skips_rows?2:1);
+      best_imp(in, local_out, left, top+start, right, top+stop,
+               output_skips_rows);
+    }, bottom-top);
 }
 
 void FX::composite_bgra(const void* in, void* out,
                         unsigned int width, unsigned int height,
                         bool output_skips_rows) {
+  makeCompositeFilters();
   static auto best_imp = FX::Imp::composite_bgra().best([&](FX::Proto::composite_bgra candidate) { candidate(in, out, width, height, output_skips_rows); });
-  Worker::performTask([=](unsigned int start, unsigned int stop) {
+  performTask([=](unsigned int start, unsigned int stop) {
       const void* local_in = reinterpret_cast<const uint8_t*>(in)
         +start*width*4;
       void* local_out = reinterpret_cast<uint8_t*>(out)
         +start*width*8*(output_skips_rows?2:1);
       best_imp(local_in, local_out, width, stop-start, output_skips_rows);
-    }, 0, height);
+    }, height);
 }
 
 void FX::svideo_bgra(const void* in, void* out,
                      unsigned int width, unsigned int height,
                      bool output_skips_rows) {
+  makeSVideoFilters();
   static auto best_imp = FX::Imp::svideo_bgra().best([&](FX::Proto::svideo_bgra candidate) { candidate(in, out, width, height, output_skips_rows); });
-  Worker::performTask([=](unsigned int start, unsigned int stop) {
+  performTask([=](unsigned int start, unsigned int stop) {
       const void* local_in = reinterpret_cast<const uint8_t*>(in)
         +start*width*4;
       void* local_out = reinterpret_cast<uint8_t*>(out)
         +start*width*8*(output_skips_rows?2:1);
       best_imp(local_in, local_out, width, stop-start, output_skips_rows);
-    }, 0, height);
+    }, height);
+}
+
+void FX::composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                              unsigned int left, unsigned int top,
+                              unsigned int right, unsigned int bottom,
+                              bool output_skips_rows) {
+  makeCompositeFilters();
+  auto best_imp = best_composite_raw_screen(in, out, left, top, right, bottom,
+                                            output_skips_rows);
+  performTask([=,&in](unsigned int start, unsigned int stop) {
+      void* local_out = reinterpret_cast<uint8_t*>(out)
+        +start*(right-left)*8*(output_skips_rows?2:1);
+      best_imp(in, local_out, left, top+start, right, top+stop,
+               output_skips_rows);
+    }, bottom-top);
+}
+
+void FX::svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                           unsigned int left, unsigned int top,
+                           unsigned int right, unsigned int bottom,
+                           bool output_skips_rows) {
+  makeSVideoFilters();
+  auto best_imp = best_svideo_raw_screen(in, out, left, top, right, bottom,
+                                         output_skips_rows);
+  performTask([=,&in](unsigned int start, unsigned int stop) {
+      void* local_out = reinterpret_cast<uint8_t*>(out)
+        +start*(right-left)*8*(output_skips_rows?2:1);
+      best_imp(in, local_out, left, top+start, right, top+stop,
+               output_skips_rows);
+    }, bottom-top);
 }
 
 void FX::scanline_crisp_bgra(void* buf,
                              unsigned int width, unsigned int height) {
-  static auto best_imp = FX::Imp::scanline_crisp_bgra().best([&](FX::Proto::scanline_crisp_bgra candidate) { candidate(buf, width, height); });
-  Worker::performTask([=](unsigned int start, unsigned int stop) {
+  auto best_imp = best_scanline_crisp_bgra(buf, width, height);
+  performTask([=](unsigned int start, unsigned int stop) {
       void* local_buf = reinterpret_cast<uint8_t*>(buf)+start*width*8;
       best_imp(local_buf, width, stop-start);
-    }, 0, height);
+    }, height);
 }
 
 void FX::scanline_bright_bgra(void* buf,
                               unsigned int width, unsigned int height) {
-  static auto best_imp = FX::Imp::scanline_bright_bgra().best([&](FX::Proto::scanline_bright_bgra candidate) { candidate(buf, width, height); });
-  Worker::performTask([=](unsigned int start, unsigned int stop) {
+  auto best_imp = best_scanline_bright_bgra(buf, width, height);
+  performTask([=](unsigned int start, unsigned int stop) {
       void* local_buf = reinterpret_cast<uint8_t*>(buf)+start*width*8;
       best_imp(local_buf, width, stop-start);
-    }, 0, height);
+    }, height);
+}
+
+void FX::filter_with_scanlines(const ARS::PPU::raw_screen& in, void* out,
+                               unsigned int left, unsigned int top,
+                               unsigned int right, unsigned int bottom,
+                               Filter filter, bool bright) {
+  // all three have the same signature
+  Proto::raw_screen_to_bgra_2x filter_imp;
+  switch(filter) {
+  default:
+  case Filter::RGB_2X:
+    filter_imp = best_raw_screen_to_bgra_2x(in, out, left, top, right, bottom,
+                                            true);
+    break;
+  case Filter::SVIDEO:
+    makeSVideoFilters();
+    filter_imp = best_svideo_raw_screen(in, out, left, top, right, bottom,
+                                        true);
+    break;
+  case Filter::COMPOSITE:
+    makeCompositeFilters();
+    filter_imp = best_composite_raw_screen(in, out, left, top, right, bottom,
+                                           true);
+    break;
+  }
+  const unsigned int width = (right-left)*2;
+  // (one row short, since out has nothing below the last row to read)
+  Proto::scanline_crisp_bgra scanline_imp
+    = bright ? best_scanline_bright_bgra(out, width, bottom-top-1)
+    : best_scanline_crisp_bgra(out, width, bottom-top-1);
+  performTask([=,&in](unsigned int start, unsigned int stop) {
+      // A band's rows, with room for the scanlines between them, and the
+      // row after the band, which the last scanline needs. This stays in
+      // cache from the filter to the scanlines to the copy into out.
+      // (Without multithreading, all the rows come at once, and go through
+      // here a band at a time.)
+      alignas(32) static thread_local uint32_t
+        band[(BAND_ROWS+1)*2][ARS::PPU::TOTAL_SCREEN_WIDTH*2];
+      uint32_t* buf = band[0];
+      for(unsigned int first = start; first < stop; first += BAND_ROWS) {
+        unsigned int rows = std::min(stop - first, BAND_ROWS);
+        unsigned int below = top + first + rows;
+        filter_imp(in, buf, left, top+first, right, below, true);
+        if(below < static_cast<unsigned int>(ARS::PPU::TOTAL_SCREEN_HEIGHT))
+          filter_imp(in, buf + rows*2*width, left, below, right, below+1,
+                     true);
+        else
+          memcpy(buf + rows*2*width, buf + (rows-1)*2*width, width*4);
+        scanline_imp(buf, width, rows);
+        memcpy(reinterpret_cast<uint32_t*>(out) + first*2*width, buf,
+               rows*2*width*4);
+      }
+    }, bottom-top);
 }
 
 #define MAKE_IMPS(x) Imp::imps<Proto::x>& Imp::x() { static Imp::imps<Proto::x> nugget; return nugget; }
@@ -192,5 +451,7 @@ MAKE_IMPS(raw_screen_to_bgra);
 MAKE_IMPS(raw_screen_to_bgra_2x);
 MAKE_IMPS(composite_bgra);
 MAKE_IMPS(svideo_bgra);
+MAKE_IMPS(composite_raw_screen);
+MAKE_IMPS(svideo_raw_screen);
 MAKE_IMPS(scanline_crisp_bgra);
 MAKE_IMPS(scanline_bright_bgra);
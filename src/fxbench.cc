@@ -62,6 +62,22 @@ namespace {
                         ARS::PPU::CONVENIENT_OVERSCAN_HEIGHT,
                         true);
       }},
+    {"composite_raw_screen", []() {
+        FX::composite_raw_screen(raw, buf2,
+                                 ARS::PPU::CONVENIENT_OVERSCAN_LEFT,
+                                 ARS::PPU::CONVENIENT_OVERSCAN_TOP,
+                                 ARS::PPU::CONVENIENT_OVERSCAN_RIGHT,
+                                 ARS::PPU::CONVENIENT_OVERSCAN_BOTTOM,
+                                 false);
+      }},
+    {"svideo_raw_screen", []() {
+        FX::svideo_raw_screen(raw, buf2,
+                              ARS::PPU::CONVENIENT_OVERSCAN_LEFT,
+                              ARS::PPU::CONVENIENT_OVERSCAN_TOP,
+                              ARS::PPU::CONVENIENT_OVERSCAN_RIGHT,
+                              ARS::PPU::CONVENIENT_OVERSCAN_BOTTOM,
+                              false);
+      }},
     {"scanline_crisp_bgra", []() {
         FX::scanline_crisp_bgra(buf2,
                                 ARS::PPU::CONVENIENT_OVERSCAN_WIDTH,
@@ -72,14 +88,73 @@ namespace {
                                  ARS::PPU::CONVENIENT_OVERSCAN_WIDTH,
                                  ARS::PPU::CONVENIENT_OVERSCAN_HEIGHT);
       }},
+    {"composite_scanlines_fused", []() {
+        FX::filter_with_scanlines(raw, buf2,
+                                  ARS::PPU::CONVENIENT_OVERSCAN_LEFT,
+                                  ARS::PPU::CONVENIENT_OVERSCAN_TOP,
+                                  ARS::PPU::CONVENIENT_OVERSCAN_RIGHT,
+                                  ARS::PPU::CONVENIENT_OVERSCAN_BOTTOM,
+                                  FX::Filter::COMPOSITE, false);
+      }},
   };
   constexpr unsigned int DEFAULT_ITERATION_COUNT = 10;
   unsigned int iteration_count = DEFAULT_ITERATION_COUNT;
+  unsigned int thread_count = 0;
+  bool check_only = false;
+  // Checks that filter_with_scanlines comes out the same as the filter and
+  // scanline passes it stands in for, for every filter.
+  bool check_fused() {
+    using namespace ARS::PPU;
+    const unsigned int left = CONVENIENT_OVERSCAN_LEFT;
+    const unsigned int top = CONVENIENT_OVERSCAN_TOP;
+    const unsigned int right = CONVENIENT_OVERSCAN_RIGHT;
+    const unsigned int bottom = CONVENIENT_OVERSCAN_BOTTOM;
+    const size_t size = (right-left)*8*(bottom-top)*2;
+    const struct { FX::Filter filter; const char* name; } filters[] = {
+      {FX::Filter::RGB_2X, "rgb"},
+      {FX::Filter::SVIDEO, "svideo"},
+      {FX::Filter::COMPOSITE, "composite"},
+    };
+    bool ok = true;
+    for(auto& filter : filters) {
+      for(bool bright : {false, true}) {
+        memset(buf1, 0, sizeof(buf1));
+        memset(buf2, 0, sizeof(buf2));
+        FX::filter_with_scanlines(raw, buf1, left, top, right, bottom,
+                                  filter.filter, bright);
+        // (one row further down, for the last scanline to be made from)
+        switch(filter.filter) {
+        case FX::Filter::RGB_2X:
+          FX::raw_screen_to_bgra_2x(raw, buf2, left, top, right, bottom+1,
+                                    true);
+          break;
+        case FX::Filter::SVIDEO:
+          FX::svideo_raw_screen(raw, buf2, left, top, right, bottom+1, true);
+          break;
+        case FX::Filter::COMPOSITE:
+          FX::composite_raw_screen(raw, buf2, left, top, right, bottom+1,
+                                   true);
+          break;
+        }
+        if(bright) FX::scanline_bright_bgra(buf2, (right-left)*2,
+                                            bottom-top);
+        else FX::scanline_crisp_bgra(buf2, (right-left)*2, bottom-top);
+        bool same = !memcmp(buf1, buf2, size);
+        std::cout << filter.name << (bright ? " bright" : " crisp")
+                  << (same ? ": OK\n" : ": MISMATCH\n");
+        if(!same) ok = false;
+      }
+    }
+    return ok;
+  }
   void print_usage() {
     std::cout << "Usage: fxbench [options] [testnames]\n"
       "Options:\n"
       "-L: List all known tests\n"
-      "-i: Number of iterations for each test, default is "<<DEFAULT_ITERATION_COUNT<<"\n";
+      "-i: Number of iterations for each test, default is "<<DEFAULT_ITERATION_COUNT<<"\n"
+      "-t: Number of FX threads, default is one per CPU\n"
+      "-c: Check filter_with_scanlines against the separate passes, instead "
+      "of timing anything\n";
   }
   void print_tests() {
     for(auto& test : tests) {
@@ -111,6 +186,14 @@ namespace {
               else if(iteration_count < 1) iteration_count = 1;
             }
             break;
+          case 't':
+            if(n >= argc) {
+              sn.Out(std::cout, "MISSING_COMMAND_LINE_ARGUMENT"_Key, {"-t"});
+              valid = false;
+            }
+            else thread_count = std::stoul(argv[n++]);
+            break;
+          case 'c': check_only = true; break;
           default:
             sn.Out(std::cerr, "UNKNOWN_OPTION"_Key, {std::string(arg-1,1)});
             valid = false;
@@ -149,12 +232,13 @@ extern "C" int teg_main(int argc, char** argv) {
   if(!parse_command_line(argc, const_cast<const char**>(argv))) return 1;
   if(SDL_Init(0)) return 1;
   atexit(SDL_Quit);
-  FX::init();
+  FX::init(thread_count);
   for(unsigned int y = 0; y < ARS::PPU::TOTAL_SCREEN_HEIGHT; ++y) {
     for(unsigned int x = 0; x < ARS::PPU::TOTAL_SCREEN_WIDTH; ++x) {
       raw[y][x] = rand();
     }
   }
+  if(check_only) return check_fused() ? 0 : 1;
   std::cout << "[";
   std::vector<double> execution_times(iteration_count);
   bool first_test = true;
@@ -0,0 +1,236 @@
+#include "fxinternal.hh"
+
+#include "io.hh"
+
+#include <array>
+#include <cstring>
+
+/* The composite and S-Video FIRs are made by simulating what an NTSC encoder
+   and a TV's decoder do to each input pixel, at each chroma phase, and
+   measuring what comes out at each subpixel. Everything in between is
+   linear, so that's all there is to know. */
+
+using namespace FX;
+
+namespace {
+  // bump this whenever the FIRs this generates change, to throw out old
+  // caches
+  constexpr int GENERATOR_VERSION = 1;
+  constexpr char CACHE_MAGIC[8] = {'A','R','S','F','I','R','\r','\n'};
+  // samples per pixel, in the simulated signal
+  constexpr int OVERSAMPLE = 24;
+  // The pixel clock is half the core clock, 390 pixels per scanline, and
+  // NTSC puts 227.5 color subcarrier cycles in a scanline; 7/12 of a cycle
+  // per pixel.
+  constexpr double PIXELS_PER_SCANLINE = ARS::CYCLES_PER_SCANLINE / 2;
+  constexpr double SUBCARRIER_CYCLES_PER_PIXEL = 227.5 / PIXELS_PER_SCANLINE;
+  static_assert(455 * NUM_CHROMA_PHASES % ARS::CYCLES_PER_SCANLINE == 0,
+                "NUM_CHROMA_PHASES doesn't fit the subcarrier");
+  // bandwidths, in cycles per pixel
+  constexpr double PIXEL_RATE_MHZ = 135.0 / 11 / 2;
+  constexpr double COMPOSITE_LUMA_CUTOFF = 3.0 / PIXEL_RATE_MHZ;
+  constexpr double SVIDEO_LUMA_CUTOFF = 4.2 / PIXEL_RATE_MHZ;
+  constexpr double CHROMA_CUTOFF = 1.3 / PIXEL_RATE_MHZ;
+  // Lowpass filter (Hann-windowed sinc) with the given cutoff, reaching out
+  // to radius pixels on either side.
+  double lowpass(double t, double cutoff, double radius) {
+    if(t <= -radius || t >= radius) return 0;
+    double x = 2 * cutoff * t;
+    double sinc = x == 0 ? 1 : std::sin(M_PI * x) / (M_PI * x);
+    return 2 * cutoff * sinc * (0.5 + 0.5 * std::cos(M_PI * t / radius));
+  }
+  // one sample of every input pixel the FIR reaches, for one subpixel
+  struct Sample { int tap; double t, luma, chroma; };
+  std::vector<Sample> getSamples(int radius, int subpixel,
+                                 double luma_cutoff, double sharpness) {
+    // where the subpixel is sampled, within the center pixel
+    double center = (subpixel + 0.5) / NUM_TV_SUBPIXELS;
+    std::vector<Sample> ret;
+    double luma_sum = 0, soft_sum = 0, chroma_sum = 0;
+    std::vector<double> soft;
+    for(int tap = 0; tap < radius * 2 + 1; ++tap) {
+      for(int n = 0; n < OVERSAMPLE; ++n) {
+        double t = tap - radius + (n + 0.5) / OVERSAMPLE;
+        Sample sample;
+        sample.tap = tap;
+        sample.t = t;
+        sample.luma = lowpass(center - t, luma_cutoff, radius);
+        sample.chroma = lowpass(center - t, CHROMA_CUTOFF, radius);
+        soft.push_back(lowpass(center - t, luma_cutoff / 2, radius));
+        luma_sum += sample.luma;
+        soft_sum += soft.back();
+        chroma_sum += sample.chroma;
+        ret.push_back(sample);
+      }
+    }
+    // Each filter passes DC unchanged. Sharpening adds the difference
+    // between the normal and a softer luma filter; softening (negative
+    // sharpness) moves toward the softer one.
+    for(size_t n = 0; n < ret.size(); ++n) {
+      double normal = ret[n].luma / luma_sum;
+      ret[n].luma = normal + sharpness * (normal - soft[n] / soft_sum);
+      ret[n].chroma /= chroma_sum;
+    }
+    return ret;
+  }
+  // 3x3 matrices, [row][column]
+  typedef std::array<std::array<double, 3>, 3> Matrix;
+  Matrix multiply(const Matrix& a, const Matrix& b) {
+    Matrix ret;
+    for(int row = 0; row < 3; ++row) {
+      for(int column = 0; column < 3; ++column) {
+        ret[row][column] = 0;
+        for(int n = 0; n < 3; ++n)
+          ret[row][column] += a[row][n] * b[n][column];
+      }
+    }
+    return ret;
+  }
+  // RGB -> YUV
+  const Matrix ENCODE = {{
+    {{0.299, 0.587, 0.114}},
+    {{-0.299*0.492, -0.587*0.492, (1-0.114)*0.492}},
+    {{(1-0.299)*0.877, -0.587*0.877, -0.114*0.877}},
+  }};
+  // YUV -> RGB
+  const Matrix DECODE = {{
+    {{1, 0, 1/0.877}},
+    {{1, -0.114/0.587/0.492, -0.299/0.587/0.877}},
+    {{1, 1/0.492, 0}},
+  }};
+  void generate(int32_t* out, bool composite, int radius,
+                const TVControls& controls) {
+    const int num_taps = radius * 2 + 1;
+    // the decoder's idea of the subcarrier's phase is off by the hue, and
+    // the strength of the color it gets out is scaled by the saturation
+    const double hue = controls.hue * M_PI / 180;
+    const Matrix adjust = {{
+      {{1, 0, 0}},
+      {{0, controls.saturation * std::cos(hue),
+        -controls.saturation * std::sin(hue)}},
+      {{0, controls.saturation * std::sin(hue),
+        controls.saturation * std::cos(hue)}},
+    }};
+    const Matrix decode = multiply(DECODE, adjust);
+    // Fixed point, and scaled so that 255 comes out as 256 (and is clamped
+    // back to 255) instead of as 254 and change.
+    const double scale = 65536.0 * 256 / 255;
+    const int32_t total = static_cast<int32_t>(std::floor(scale + 0.5));
+    for(int subpixel = 0; subpixel < NUM_TV_SUBPIXELS; ++subpixel) {
+      auto samples = getSamples(radius, subpixel,
+                                composite ? COMPOSITE_LUMA_CUTOFF
+                                : SVIDEO_LUMA_CUTOFF, controls.sharpness);
+      for(int phase = 0; phase < NUM_CHROMA_PHASES; ++phase) {
+        // how each tap's Y, U, and V come out as the decoder's Y, U, and V
+        std::vector<Matrix> taps(num_taps);
+        for(auto& tap : taps)
+          for(auto& row : tap) row.fill(0);
+        for(auto& sample : samples) {
+          double angle = 2 * M_PI * SUBCARRIER_CYCLES_PER_PIXEL
+            * (phase + sample.t);
+          // what each of the pixel's Y, U, and V put into the signal(s)...
+          double luma[3] = {1, 0, 0};
+          double chroma[3] = {0, std::sin(angle), std::cos(angle)};
+          if(composite) {
+            luma[1] = chroma[1];
+            luma[2] = chroma[2];
+            chroma[0] = 1;
+          }
+          // ...and what the decoder takes back out
+          auto& tap = taps[sample.tap];
+          for(int n = 0; n < 3; ++n) {
+            tap[0][n] += sample.luma * luma[n];
+            tap[1][n] += 2 * sample.chroma * std::sin(angle) * chroma[n];
+            tap[2][n] += 2 * sample.chroma * std::cos(angle) * chroma[n];
+          }
+        }
+        int32_t* fir = out + (phase * NUM_TV_SUBPIXELS + subpixel)
+          * num_taps * 9;
+        int32_t sums[3] = {0, 0, 0};
+        for(int tap = 0; tap < num_taps; ++tap) {
+          Matrix m = multiply(decode, multiply(taps[tap], ENCODE));
+          for(int in_channel = 0; in_channel < 3; ++in_channel) {
+            for(int out_channel = 0; out_channel < 3; ++out_channel) {
+              int32_t coef = static_cast<int32_t>
+                (std::floor(m[out_channel][in_channel] * scale + 0.5));
+              fir[tap * 9 + in_channel * 3 + out_channel] = coef;
+              sums[out_channel] += coef;
+            }
+          }
+        }
+        // make sure gray comes out exactly gray, despite the rounding
+        for(int n = 0; n < 3; ++n)
+          fir[radius * 9 + n * 3 + n] += total - sums[n];
+      }
+    }
+  }
+  std::string getCacheName(bool composite) {
+    return composite ? "Composite Filter.cache" : "S-Video Filter.cache";
+  }
+  /* Everything the FIR depends on, at the start of its cache, followed by
+     the table itself. Both are in this machine's byte order; a cache from
+     a machine with the other one fails to match on byte_order, and is
+     regenerated like any other mismatch. */
+  struct CacheHeader {
+    char magic[sizeof(CACHE_MAGIC)];
+    uint32_t byte_order, generator_version;
+    int32_t composite, radius, num_chroma_phases, num_tv_subpixels;
+    float hue, saturation, sharpness;
+    uint32_t table_length;
+  };
+  static_assert(sizeof(CacheHeader) == sizeof(CACHE_MAGIC) + 10 * 4,
+                "CacheHeader has padding in it");
+  CacheHeader makeCacheHeader(bool composite, int radius,
+                              const TVControls& controls, size_t length) {
+    CacheHeader header;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.byte_order = 0x01020304;
+    header.generator_version = GENERATOR_VERSION;
+    header.composite = composite;
+    header.radius = radius;
+    header.num_chroma_phases = NUM_CHROMA_PHASES;
+    header.num_tv_subpixels = NUM_TV_SUBPIXELS;
+    header.hue = controls.hue;
+    header.saturation = controls.saturation;
+    header.sharpness = controls.sharpness;
+    header.table_length = length;
+    return header;
+  }
+  bool loadCachedFIR(std::vector<int32_t>& table, bool composite,
+                     const CacheHeader& header) {
+    auto i = IO::OpenConfigFileForRead(getCacheName(composite));
+    if(!i || !*i) return false;
+    CacheHeader cached_header;
+    i->read(reinterpret_cast<char*>(&cached_header), sizeof(cached_header));
+    if(!*i || memcmp(&cached_header, &header, sizeof(header))) return false;
+    i->read(reinterpret_cast<char*>(table.data()),
+            table.size() * sizeof(int32_t));
+    // a short file, or one with anything after the table, is no good either
+    return *i && i->peek() == std::char_traits<char>::eof();
+  }
+  void saveCachedFIR(const std::vector<int32_t>& table, bool composite,
+                     const CacheHeader& header) {
+    // if this doesn't work out, the FIR just gets generated again next time
+    auto name = getCacheName(composite);
+    auto o = IO::OpenConfigFileForWrite(name);
+    if(!o || !*o) return;
+    o->write(reinterpret_cast<const char*>(&header), sizeof(header));
+    o->write(reinterpret_cast<const char*>(table.data()),
+             table.size() * sizeof(int32_t));
+    if(!*o) return;
+    o.reset();
+    IO::UpdateConfigFile(name);
+  }
+}
+
+FX::TVFIR::TVFIR(bool composite, const TVControls& controls)
+  : radius(composite ? COMPOSITE_FILTER_RADIUS : SVIDEO_FILTER_RADIUS),
+    num_taps(radius*2+1) {
+  table.resize(NUM_CHROMA_PHASES * NUM_TV_SUBPIXELS * num_taps * 9);
+  CacheHeader header = makeCacheHeader(composite, radius, controls,
+                                       table.size());
+  if(!loadCachedFIR(table, composite, header)) {
+    generate(table.data(), composite, radius, controls);
+    saveCachedFIR(table, composite, header);
+  }
+}
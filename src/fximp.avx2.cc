@@ -0,0 +1,253 @@
+#include "optimize-this-file.hh"
+#include "fxinternal.hh"
+
+#include <assert.h>
+
+// See fximp.sse2.cc for why this is done per function.
+#if defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+
+#define AVX2 __attribute__((target("avx2")))
+
+using namespace FX;
+
+namespace {
+  const bool have_avx2 = SDL_HasAVX2();
+  AVX2 inline __m256i load(const void* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  // eight palette indices to eight pixels
+  AVX2 inline __m256i gather_pixels(const uint8_t* in) {
+    __m256i indices = _mm256_cvtepu8_epi32
+      (_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>
+                                  (hardwarePalette), indices, 4);
+  }
+  // BGRA sums for subpixel 0 in the low half and subpixel 1 in the high half
+  // to two pixels, clamped the way pack_pixel does
+  AVX2 inline void store_pixel_pair(uint32_t* out, __m256i sums) {
+    __m256i packed = _mm256_srai_epi32(sums, 16);
+    packed = _mm256_packs_epi32(packed, packed);
+    packed = _mm256_packus_epi16(packed, packed);
+    __m128i pair = _mm_unpacklo_epi32(_mm256_castsi256_si128(packed),
+                                      _mm256_extracti128_si256(packed, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), pair);
+  }
+  AVX2 void raw_screen_to_bgra(const ARS::PPU::raw_screen& in,
+                               void* _out,
+                               unsigned int left, unsigned int top,
+                               unsigned int right, unsigned int bot,
+                               bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    __m256i* out = reinterpret_cast<__m256i*>(_out);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = left; x < right; x += 8)
+        _mm256_storeu_si256(out++, gather_pixels(&in_row[x]));
+      if(output_skips_rows) out += (right-left)/8;
+    }
+  }
+  IMPLEMENT_IF(raw_screen_to_bgra, have_avx2);
+  AVX2 void raw_screen_to_bgra_2x(const ARS::PPU::raw_screen& in,
+                                  void* _out,
+                                  unsigned int left, unsigned int top,
+                                  unsigned int right, unsigned int bot,
+                                  bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    __m256i* out = reinterpret_cast<__m256i*>(_out);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = left; x < right; x += 8) {
+        __m256i pixels = gather_pixels(&in_row[x]);
+        // within each half: 0 0 1 1 / 4 4 5 5, and 2 2 3 3 / 6 6 7 7
+        __m256i low = _mm256_unpacklo_epi32(pixels, pixels);
+        __m256i high = _mm256_unpackhi_epi32(pixels, pixels);
+        _mm256_storeu_si256(out++, _mm256_permute2x128_si256(low,high,0x20));
+        _mm256_storeu_si256(out++, _mm256_permute2x128_si256(low,high,0x31));
+      }
+      if(output_skips_rows) out += (right-left)/4;
+    }
+  }
+  IMPLEMENT_IF(raw_screen_to_bgra_2x, have_avx2);
+  AVX2 void filter_bgra(const VectorFIR& fir,
+                        const void* restrict _in, void* restrict _out,
+                        unsigned int width, unsigned int height,
+                        bool output_skips_rows) {
+    assert(width%8 == 0);
+    const uint32_t* restrict in_row = reinterpret_cast<const uint32_t*>(_in);
+    uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    for(unsigned int y = 0; y < height; ++y) {
+      unsigned int start_phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
+      if(y & 1) start_phase += NUM_CHROMA_PHASES/2;
+      start_phase %= NUM_CHROMA_PHASES;
+      int start_x = -fir.radius;
+      int end_x = fir.radius;
+      for(int center_x = 0; center_x < static_cast<int>(width); ++center_x) {
+        const int16_t* restrict tap = fir.get(start_phase);
+        if(start_x < 0)
+          tap += start_x * -VectorFIR::TAP_SIZE;
+        // both subpixels at once
+        __m256i high = _mm256_setzero_si256(), low = _mm256_setzero_si256();
+        for(int sub_x = start_x < 0 ? 0 : start_x; sub_x <= end_x; ++sub_x) {
+          uint32_t pix = in_row[sub_x];
+          __m256i bg = _mm256_set1_epi32((pix & 255) | ((pix << 8) & 0xFF0000));
+          __m256i ra = _mm256_set1_epi32(((pix >> 16) & 255)
+                                         | ((pix >> 8) & 0xFF0000));
+          high = _mm256_add_epi32(high, _mm256_add_epi32
+                                  (_mm256_madd_epi16(bg, load(tap)),
+                                   _mm256_madd_epi16(ra, load(tap + 16))));
+          low = _mm256_add_epi32(low, _mm256_add_epi32
+                                 (_mm256_madd_epi16(bg, load(tap + 32)),
+                                  _mm256_madd_epi16(ra, load(tap + 48))));
+          tap += VectorFIR::TAP_SIZE;
+        }
+        store_pixel_pair(out, _mm256_add_epi32(_mm256_slli_epi32(high, 8),
+                                               low));
+        out += 2;
+        start_phase = (start_phase + 1) % NUM_CHROMA_PHASES;
+        ++start_x;
+        ++end_x;
+      }
+      if(output_skips_rows) out += width * 2;
+      in_row += width;
+    }
+  }
+  AVX2 void composite_bgra(const void* restrict in, void* restrict out,
+                           unsigned int width, unsigned int height,
+                           bool output_skips_rows) {
+    filter_bgra(compositeVectorFIR(), in, out, width, height,
+                output_skips_rows);
+  }
+  IMPLEMENT_IF(composite_bgra, have_avx2);
+  AVX2 void svideo_bgra(const void* restrict in, void* restrict out,
+                        unsigned int width, unsigned int height,
+                        bool output_skips_rows) {
+    filter_bgra(svideoVectorFIR(), in, out, width, height,
+                output_skips_rows);
+  }
+  IMPLEMENT_IF(svideo_bgra, have_avx2);
+  AVX2 void filter_raw_screen(const IndexedFIR& fir,
+                              const ARS::PPU::raw_screen& in, void* _out,
+                              unsigned int left, unsigned int top,
+                              unsigned int right, unsigned int bot,
+                              bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    assert(fir.radius <= COMPOSITE_FILTER_RADIUS);
+    uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const unsigned int width = right - left;
+    const unsigned int num_slots = fir.num_slots;
+    // the row, as slots, with slot 0 (nothing) on either side
+    uint8_t row[ARS::PPU::TOTAL_SCREEN_WIDTH + COMPOSITE_FILTER_RADIUS*2];
+    memset(row, 0, fir.radius);
+    memset(row + fir.radius + width, 0, fir.radius);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = 0; x < width; ++x)
+        row[fir.radius + x] = fir.slots[in_row[left + x]];
+      unsigned int phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
+      if(y & 1) phase += NUM_CHROMA_PHASES/2;
+      phase %= NUM_CHROMA_PHASES;
+      for(unsigned int x = 0; x < width; ++x) {
+        const IndexedFIR::Contribution* restrict tap = fir.get(phase);
+        __m256i sums = _mm256_setzero_si256();
+        for(int n = 0; n < fir.num_taps; ++n) {
+          sums = _mm256_add_epi32(sums, load(tap + row[x + n] * 2));
+          tap += num_slots * 2;
+        }
+        store_pixel_pair(out, sums);
+        out += 2;
+        if(++phase == NUM_CHROMA_PHASES) phase = 0;
+      }
+      if(output_skips_rows) out += width * 2;
+    }
+  }
+  AVX2 void composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                                 unsigned int left, unsigned int top,
+                                 unsigned int right, unsigned int bot,
+                                 bool output_skips_rows) {
+    filter_raw_screen(compositeIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT_IF(composite_raw_screen, have_avx2);
+  AVX2 void svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                              unsigned int left, unsigned int top,
+                              unsigned int right, unsigned int bot,
+                              bool output_skips_rows) {
+    filter_raw_screen(svideoIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT_IF(svideo_raw_screen, have_avx2);
+  // The linearizer's table, widened to 32 bits so it can be gathered from.
+  // (The delinearizer's can be gathered from as is, four bytes at a time; no
+  // sum we look up is close enough to the end for that to overrun it.)
+  struct WideLinearize {
+    int32_t linearized[256];
+    WideLinearize() {
+      auto& linearizer = FX::linearizer();
+      for(int n = 0; n < 256; ++n) linearized[n] = linearizer[n];
+    }
+  };
+  const WideLinearize& wide_linearizer() {
+    static const WideLinearize wide_linearize;
+    return wide_linearize;
+  }
+  // one channel of eight pixels above and below, averaged in linear space,
+  // divided by 2 to the shift, and delinearized
+  template<int channel, int shift>
+  AVX2 inline __m256i scanline_channel(__m256i above, __m256i below,
+                                       const int* linear,
+                                       const int* delinear) {
+    const __m256i mask = _mm256_set1_epi32(255);
+    __m256i sum = _mm256_add_epi32
+      (_mm256_i32gather_epi32(linear, _mm256_and_si256
+                              (_mm256_srli_epi32(above, channel*8), mask), 4),
+       _mm256_i32gather_epi32(linear, _mm256_and_si256
+                              (_mm256_srli_epi32(below, channel*8), mask), 4));
+    return _mm256_slli_epi32(_mm256_and_si256(_mm256_i32gather_epi32
+                                              (delinear,
+                                               _mm256_srli_epi32(sum, shift),
+                                               1), mask), channel*8);
+  }
+  template<int shift>
+  AVX2 void scanline_bgra(void* restrict _buf,
+                          unsigned int width, unsigned int height) {
+    auto linear = wide_linearizer().linearized;
+    auto delinear = reinterpret_cast<const int*>(FX::delinearizer().data());
+    static_assert(shift >= 2, "a gather from the delinearizer could overrun");
+    assert(width%8 == 0);
+    uint32_t* restrict in_row1 = reinterpret_cast<uint32_t*>(_buf);
+    uint32_t* restrict out = in_row1 + width;
+    uint32_t* restrict in_row2 = out + width;
+    for(unsigned int y = 0; y < height; ++y) {
+      for(unsigned int x = 0; x < width; x += 8) {
+        __m256i above = load(in_row1 + x);
+        __m256i below = load(in_row2 + x);
+        __m256i pixels = _mm256_or_si256
+          (_mm256_or_si256(scanline_channel<2, shift>(above, below,
+                                                      linear, delinear),
+                           scanline_channel<1, shift>(above, below,
+                                                      linear, delinear)),
+           scanline_channel<0, shift>(above, below, linear, delinear));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), pixels);
+      }
+      in_row1 += width * 2;
+      out += width * 2;
+      in_row2 += width * 2;
+    }
+  }
+  AVX2 void scanline_crisp_bgra(void* restrict buf,
+                                unsigned int width, unsigned int height) {
+    scanline_bgra<3>(buf, width, height);
+  }
+  IMPLEMENT_IF(scanline_crisp_bgra, have_avx2);
+  AVX2 void scanline_bright_bgra(void* restrict buf,
+                                 unsigned int width, unsigned int height) {
+    scanline_bgra<2>(buf, width, height);
+  }
+  IMPLEMENT_IF(scanline_bright_bgra, have_avx2);
+}
+
+#endif
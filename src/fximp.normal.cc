@@ -50,6 +50,7 @@ namespace {
     assert(width%8 == 0);
     const uint32_t* restrict in_row = reinterpret_cast<const uint32_t*>(_in);
     uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const TVFIR& fir = compositeFIR();
     for(unsigned int y = 0; y < height; ++y) {
       unsigned int start_phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
       if(y & 1) start_phase += NUM_CHROMA_PHASES/2;
@@ -59,7 +60,7 @@ namespace {
       for(int center_x = 0; center_x < static_cast<int>(width); ++center_x) {
         for(unsigned int subpixel = 0; subpixel < 2; ++subpixel) {
           unsigned int phase = start_phase;
-          const int32_t* restrict filter_ptr = COMPOSITE_FIR[phase][subpixel];
+          const int32_t* restrict filter_ptr = fir.get(phase, subpixel);
           if(start_x < 0)
             filter_ptr += start_x * -9;
           int32_t summed_red = 0, summed_green = 0, summed_blue = 0;
@@ -96,6 +97,7 @@ namespace {
     assert(width%8 == 0);
     const uint32_t* restrict in_row = reinterpret_cast<const uint32_t*>(_in);
     uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const TVFIR& fir = svideoFIR();
     for(unsigned int y = 0; y < height; ++y) {
       unsigned int start_phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
       if(y & 1) start_phase += NUM_CHROMA_PHASES/2;
@@ -105,7 +107,7 @@ namespace {
       for(int center_x = 0; center_x < static_cast<int>(width); ++center_x) {
         for(unsigned int subpixel = 0; subpixel < 2; ++subpixel) {
           unsigned int phase = start_phase;
-          const int32_t* restrict filter_ptr = SVIDEO_FIR[phase][subpixel];
+          const int32_t* restrict filter_ptr = fir.get(phase, subpixel);
           if(start_x < 0)
             filter_ptr += start_x * -9;
           int32_t summed_red = 0, summed_green = 0, summed_blue = 0;
@@ -136,6 +138,67 @@ namespace {
     }
   }
   IMPLEMENT(svideo_bgra);
+  void filter_raw_screen(const IndexedFIR& fir,
+                         const ARS::PPU::raw_screen& in, void* _out,
+                         unsigned int left, unsigned int top,
+                         unsigned int right, unsigned int bot,
+                         bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    assert(fir.radius <= COMPOSITE_FILTER_RADIUS);
+    uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const unsigned int width = right - left;
+    const unsigned int num_slots = fir.num_slots;
+    // the row, as slots, with slot 0 (nothing) on either side
+    uint8_t row[ARS::PPU::TOTAL_SCREEN_WIDTH + COMPOSITE_FILTER_RADIUS*2];
+    memset(row, 0, fir.radius);
+    memset(row + fir.radius + width, 0, fir.radius);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = 0; x < width; ++x)
+        row[fir.radius + x] = fir.slots[in_row[left + x]];
+      // As in composite_bgra, the phase starts over at the left edge of the
+      // region. Rows alternate by their number on the screen, so bands of
+      // any size agree (and, with an even top, so does composite_bgra).
+      unsigned int phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
+      if(y & 1) phase += NUM_CHROMA_PHASES/2;
+      phase %= NUM_CHROMA_PHASES;
+      for(unsigned int x = 0; x < width; ++x) {
+        const IndexedFIR::Contribution* restrict tap = fir.get(phase);
+        int32_t summed_red[2] = {}, summed_green[2] = {}, summed_blue[2] = {};
+        for(int n = 0; n < fir.num_taps; ++n) {
+          auto contribution = tap + row[x + n] * 2;
+          for(unsigned int subpixel = 0; subpixel < 2; ++subpixel) {
+            summed_red[subpixel] += contribution[subpixel].red;
+            summed_green[subpixel] += contribution[subpixel].green;
+            summed_blue[subpixel] += contribution[subpixel].blue;
+          }
+          tap += num_slots * 2;
+        }
+        for(unsigned int subpixel = 0; subpixel < 2; ++subpixel)
+          *out++ = pack_pixel(summed_red[subpixel], summed_green[subpixel],
+                              summed_blue[subpixel]);
+        if(++phase == NUM_CHROMA_PHASES) phase = 0;
+      }
+      if(output_skips_rows) out += width * 2;
+    }
+  }
+  void composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                            unsigned int left, unsigned int top,
+                            unsigned int right, unsigned int bot,
+                            bool output_skips_rows) {
+    filter_raw_screen(compositeIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT(composite_raw_screen);
+  void svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                         unsigned int left, unsigned int top,
+                         unsigned int right, unsigned int bot,
+                         bool output_skips_rows) {
+    filter_raw_screen(svideoIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT(svideo_raw_screen);
   void scanline_crisp_bgra(void* restrict _buf,
                            unsigned int width, unsigned int height) {
     auto& linearizer = FX::linearizer();
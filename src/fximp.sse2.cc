@@ -0,0 +1,178 @@
+#include "optimize-this-file.hh"
+#include "fxinternal.hh"
+
+#include <assert.h>
+
+// Everything here is compiled for SSE2 function by function, rather than by
+// giving the whole file -msse2, so that the same build runs (and just doesn't
+// offer these) on a CPU without it.
+#if defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>
+
+#define SSE2 __attribute__((target("sse2")))
+
+using namespace FX;
+
+namespace {
+  const bool have_sse2 = SDL_HasSSE2();
+  // two sets of BGRA sums to two pixels, clamped the way pack_pixel does
+  SSE2 inline void store_pixel_pair(uint32_t* out, __m128i a, __m128i b) {
+    __m128i packed = _mm_packs_epi32(_mm_srai_epi32(a, 16),
+                                     _mm_srai_epi32(b, 16));
+    packed = _mm_packus_epi16(packed, packed);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+  }
+  SSE2 inline __m128i load(const void* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  SSE2 void raw_screen_to_bgra_2x(const ARS::PPU::raw_screen& in,
+                                  void* _out,
+                                  unsigned int left, unsigned int top,
+                                  unsigned int right, unsigned int bot,
+                                  bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    __m128i* out = reinterpret_cast<__m128i*>(_out);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = left; x < right; x += 8) {
+        __m128i a = _mm_set_epi32(hardwarePalette[in_row[x+3]],
+                                  hardwarePalette[in_row[x+2]],
+                                  hardwarePalette[in_row[x+1]],
+                                  hardwarePalette[in_row[x]]);
+        __m128i b = _mm_set_epi32(hardwarePalette[in_row[x+7]],
+                                  hardwarePalette[in_row[x+6]],
+                                  hardwarePalette[in_row[x+5]],
+                                  hardwarePalette[in_row[x+4]]);
+        _mm_storeu_si128(out++, _mm_unpacklo_epi32(a, a));
+        _mm_storeu_si128(out++, _mm_unpackhi_epi32(a, a));
+        _mm_storeu_si128(out++, _mm_unpacklo_epi32(b, b));
+        _mm_storeu_si128(out++, _mm_unpackhi_epi32(b, b));
+      }
+      if(output_skips_rows) out += (right-left)/2;
+    }
+  }
+  IMPLEMENT_IF(raw_screen_to_bgra_2x, have_sse2);
+  SSE2 void filter_bgra(const VectorFIR& fir,
+                        const void* restrict _in, void* restrict _out,
+                        unsigned int width, unsigned int height,
+                        bool output_skips_rows) {
+    assert(width%8 == 0);
+    const uint32_t* restrict in_row = reinterpret_cast<const uint32_t*>(_in);
+    uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const __m128i zero = _mm_setzero_si128();
+    for(unsigned int y = 0; y < height; ++y) {
+      unsigned int start_phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
+      if(y & 1) start_phase += NUM_CHROMA_PHASES/2;
+      start_phase %= NUM_CHROMA_PHASES;
+      int start_x = -fir.radius;
+      int end_x = fir.radius;
+      for(int center_x = 0; center_x < static_cast<int>(width); ++center_x) {
+        const int16_t* restrict tap = fir.get(start_phase);
+        if(start_x < 0)
+          tap += start_x * -VectorFIR::TAP_SIZE;
+        __m128i high0 = zero, high1 = zero, low0 = zero, low1 = zero;
+        for(int sub_x = start_x < 0 ? 0 : start_x; sub_x <= end_x; ++sub_x) {
+          __m128i pix = _mm_unpacklo_epi8(_mm_cvtsi32_si128(in_row[sub_x]),
+                                          zero);
+          __m128i bg = _mm_shuffle_epi32(pix, 0x00);
+          __m128i ra = _mm_shuffle_epi32(pix, 0x55);
+          high0 = _mm_add_epi32(high0, _mm_add_epi32
+                                (_mm_madd_epi16(bg, load(tap)),
+                                 _mm_madd_epi16(ra, load(tap + 16))));
+          high1 = _mm_add_epi32(high1, _mm_add_epi32
+                                (_mm_madd_epi16(bg, load(tap + 8)),
+                                 _mm_madd_epi16(ra, load(tap + 24))));
+          low0 = _mm_add_epi32(low0, _mm_add_epi32
+                               (_mm_madd_epi16(bg, load(tap + 32)),
+                                _mm_madd_epi16(ra, load(tap + 48))));
+          low1 = _mm_add_epi32(low1, _mm_add_epi32
+                               (_mm_madd_epi16(bg, load(tap + 40)),
+                                _mm_madd_epi16(ra, load(tap + 56))));
+          tap += VectorFIR::TAP_SIZE;
+        }
+        store_pixel_pair(out,
+                         _mm_add_epi32(_mm_slli_epi32(high0, 8), low0),
+                         _mm_add_epi32(_mm_slli_epi32(high1, 8), low1));
+        out += 2;
+        start_phase = (start_phase + 1) % NUM_CHROMA_PHASES;
+        ++start_x;
+        ++end_x;
+      }
+      if(output_skips_rows) out += width * 2;
+      in_row += width;
+    }
+  }
+  SSE2 void composite_bgra(const void* restrict in, void* restrict out,
+                           unsigned int width, unsigned int height,
+                           bool output_skips_rows) {
+    filter_bgra(compositeVectorFIR(), in, out, width, height,
+                output_skips_rows);
+  }
+  IMPLEMENT_IF(composite_bgra, have_sse2);
+  SSE2 void svideo_bgra(const void* restrict in, void* restrict out,
+                        unsigned int width, unsigned int height,
+                        bool output_skips_rows) {
+    filter_bgra(svideoVectorFIR(), in, out, width, height,
+                output_skips_rows);
+  }
+  IMPLEMENT_IF(svideo_bgra, have_sse2);
+  SSE2 void filter_raw_screen(const IndexedFIR& fir,
+                              const ARS::PPU::raw_screen& in, void* _out,
+                              unsigned int left, unsigned int top,
+                              unsigned int right, unsigned int bot,
+                              bool output_skips_rows) {
+    assert(left%8 == 0);
+    assert(right%8 == 0);
+    assert(fir.radius <= COMPOSITE_FILTER_RADIUS);
+    uint32_t* restrict out = reinterpret_cast<uint32_t*>(_out);
+    const unsigned int width = right - left;
+    const unsigned int num_slots = fir.num_slots;
+    // the row, as slots, with slot 0 (nothing) on either side
+    uint8_t row[ARS::PPU::TOTAL_SCREEN_WIDTH + COMPOSITE_FILTER_RADIUS*2];
+    memset(row, 0, fir.radius);
+    memset(row + fir.radius + width, 0, fir.radius);
+    for(unsigned int y = top; y < bot; ++y) {
+      auto& in_row = in[y];
+      for(unsigned int x = 0; x < width; ++x)
+        row[fir.radius + x] = fir.slots[in_row[left + x]];
+      unsigned int phase = (ARS::HARD_BLANK_CYCLES_PER_SCANLINE / 2);
+      if(y & 1) phase += NUM_CHROMA_PHASES/2;
+      phase %= NUM_CHROMA_PHASES;
+      for(unsigned int x = 0; x < width; ++x) {
+        const IndexedFIR::Contribution* restrict tap = fir.get(phase);
+        __m128i sum0 = _mm_setzero_si128(), sum1 = _mm_setzero_si128();
+        for(int n = 0; n < fir.num_taps; ++n) {
+          auto contribution = tap + row[x + n] * 2;
+          sum0 = _mm_add_epi32(sum0, load(contribution));
+          sum1 = _mm_add_epi32(sum1, load(contribution + 1));
+          tap += num_slots * 2;
+        }
+        store_pixel_pair(out, sum0, sum1);
+        out += 2;
+        if(++phase == NUM_CHROMA_PHASES) phase = 0;
+      }
+      if(output_skips_rows) out += width * 2;
+    }
+  }
+  SSE2 void composite_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                                 unsigned int left, unsigned int top,
+                                 unsigned int right, unsigned int bot,
+                                 bool output_skips_rows) {
+    filter_raw_screen(compositeIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT_IF(composite_raw_screen, have_sse2);
+  SSE2 void svideo_raw_screen(const ARS::PPU::raw_screen& in, void* out,
+                              unsigned int left, unsigned int top,
+                              unsigned int right, unsigned int bot,
+                              bool output_skips_rows) {
+    filter_raw_screen(svideoIndexedFIR(), in, out, left, top, right, bot,
+                      output_skips_rows);
+  }
+  IMPLEMENT_IF(svideo_raw_screen, have_sse2);
+  // The scanline filters are nothing but table lookups, and SSE2 has no
+  // gather, so there's nothing to gain over fximp.normal.cc for them here.
+}
+
+#endif
@@ -3,6 +3,12 @@
 #include "io.hh"
 #include <zlib.h>
 
+#ifdef MMAP_AVAILABLE
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace {
   constexpr unsigned int END_OF_CENTRAL_DIRECTORY_LENGTH = 22;
   constexpr unsigned int CENTRAL_FILE_HEADER_LENGTH = 46;
@@ -28,11 +34,16 @@ namespace {
     std::shared_ptr<std::istream> in;
     uint32_t offset;
     std::string name;
+    // as the central directory claims; Load checks it against the data
+    uint32_t central_crc32;
   public:
-    ReadyToDecodeFile() : offset(0xFFFFFFFF) {}
+    ReadyToDecodeFile() : offset(0xFFFFFFFF), central_crc32(0) {}
     ReadyToDecodeFile(std::shared_ptr<std::istream> in,
-                      uint32_t offset, std::string name)
-      : in(std::move(in)), offset(offset), name(name) {}
+                      uint32_t offset, std::string name,
+                      uint32_t central_crc32)
+      : in(std::move(in)), offset(offset), name(name),
+        central_crc32(central_crc32) {}
+    uint32_t getCRC() const { return central_crc32; }
     std::unique_ptr<uint8_t[]> Load(size_t& out_size,
                                     uint32_t pad_to_size = ~uint32_t(0),
                                     uint8_t pad = 0) {
@@ -165,7 +176,8 @@ namespace {
           // done!
         }
         }
-        if(!calculated_crc32.check(crc32))
+        if(!calculated_crc32.check(crc32)
+           || !calculated_crc32.check(central_crc32))
           throw sn.Get("GAME_ARCHIVE_ZIP_CORRUPTED"_Key);
         assert(ret);
         out_size = uncompressed_size;
@@ -178,15 +190,122 @@ namespace {
       }
     }
   };
+#ifdef MMAP_AVAILABLE
+  /* Decompressed ROMs are kept in the user's cache directory, so that the
+     next launch of the same archive can map them instead of inflating them
+     again. A cache file is the padded ROM image, followed by a trailer:
+     "ARSROMC", a version byte, a 32-bit little-endian key length, and the
+     key. The key names the archive's real path, size, and modification time,
+     and the member's name, central directory CRC, and padding; the file is
+     named after a hash of it, and only used if the whole key matches.
+
+     Anything that goes wrong with the cache just means inflating as usual.
+     Nothing ever cleans it up; an archive that changes leaves its old
+     entries behind, and deleting the directory is always safe. */
+  const char CACHE_MAGIC[8] = {'A','R','S','R','O','M','C',1};
+  constexpr size_t CACHE_TRAILER_LENGTH = sizeof(CACHE_MAGIC) + 4;
+  const std::string& getCacheDir() {
+    static const std::string dir = []() -> std::string {
+      std::string dir;
+      const char* xdg = getenv("XDG_CACHE_HOME");
+      const char* home = getenv("HOME");
+#if __APPLE__
+      xdg = nullptr;
+      if(home != nullptr && *home) dir = std::string(home) + "/Library/Caches";
+#else
+      if(xdg != nullptr && *xdg) dir = xdg;
+      else if(home != nullptr && *home) dir = std::string(home) + "/.cache";
+#endif
+      if(dir.empty()) return dir;
+      mkdir(dir.c_str(), 0700);
+      dir += "/ars-emu";
+      mkdir(dir.c_str(), 0700);
+      struct stat st;
+      if(stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) dir.clear();
+      return dir;
+    }();
+    return dir;
+  }
+  // empty if the archive's contents can't be cached
+  std::string getArchiveCacheKey(const std::string& path) {
+    if(getCacheDir().empty()) return std::string();
+    char* real = realpath(path.c_str(), nullptr);
+    if(real == nullptr) return std::string();
+    std::string ret = real;
+    free(real);
+    struct stat st;
+    if(stat(ret.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+      return std::string();
+    ret += '\0';
+    ret += TEG::format("%lld %lld", (long long)st.st_size,
+                       (long long)st.st_mtime);
+    ret += '\0';
+    return ret;
+  }
+  std::string getCachePath(const std::string& key) {
+    // FNV-1a; the key itself is checked, so collisions only cost a miss
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for(char c : key) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 0x100000001B3ULL;
+    }
+    return getCacheDir() + TEG::format("/%016llx.rom",
+                                       (unsigned long long)hash);
+  }
+  std::unique_ptr<ARS::Memory> loadCachedROM(const std::string& cache_path,
+                                             const std::string& key,
+                                             size_t size) {
+    int fd = open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return nullptr;
+    std::unique_ptr<ARS::Memory> ret;
+    struct stat st;
+    std::string trailer(CACHE_TRAILER_LENGTH + key.length(), '\0');
+    if(fstat(fd, &st) == 0
+       && st.st_size == static_cast<off_t>(size + trailer.length())
+       && pread(fd, &trailer[0], trailer.length(), size)
+       == static_cast<ssize_t>(trailer.length())) {
+      std::string expected(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+      for(int n = 0; n < 4; ++n) expected += char(key.length() >> (n * 8));
+      expected += key;
+      if(trailer == expected) ret = ARS::mapROMContent(fd, size);
+    }
+    close(fd);
+    return ret;
+  }
+  void saveCachedROM(const std::string& cache_path, const std::string& key,
+                     const uint8_t* data, size_t size) {
+    // written under a temporary name and renamed into place, so that another
+    // process launching the same archive never maps half a file
+    std::string temp_path = cache_path + TEG::format(".%d", (int)getpid());
+    auto out = IO::OpenRawPathForWrite(temp_path, false);
+    if(!out || !*out) return;
+    out->write(reinterpret_cast<const char*>(data), size);
+    out->write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    for(int n = 0; n < 4; ++n) out->put(char(key.length() >> (n * 8)));
+    out->write(key.data(), key.length());
+    out->flush();
+    bool good = !!*out;
+    out.reset();
+    if(!good || rename(temp_path.c_str(), cache_path.c_str()) != 0)
+      unlink(temp_path.c_str());
+  }
+#endif
   class GameArchive : public ARS::GameFolder {
     std::unordered_map<std::string, ReadyToDecodeFile> files;
     std::string prefix;
+#ifdef MMAP_AVAILABLE
+    std::string cache_key;
+#endif
   public:
     GameArchive(std::unordered_map<std::string, ReadyToDecodeFile> files,
                 std::string path, std::string prefix,
                 std::unique_ptr<byuuML::document> manifest)
       : GameFolder(path, std::move(manifest)),
-        files(std::move(files)), prefix(std::move(prefix)) {}
+        files(std::move(files)), prefix(std::move(prefix)) {
+#ifdef MMAP_AVAILABLE
+      cache_key = getArchiveCacheKey(path);
+#endif
+    }
     std::unique_ptr<ARS::Memory> getROMContent(std::string name,
                                                size_t size,
                                                uint8_t pad = 0) override {
@@ -194,8 +313,22 @@ namespace {
       auto it = files.find(path);
       if(it == files.end())
         throw sn.Get("GAMEFOLDER_FILE_MISSING"_Key, {name});
+#ifdef MMAP_AVAILABLE
+      std::string key, cache_path;
+      if(!cache_key.empty()) {
+        key = cache_key + path + '\0'
+          + TEG::format("%08x %llu %02x", it->second.getCRC(),
+                        (unsigned long long)size, pad);
+        cache_path = getCachePath(key);
+        auto ret = loadCachedROM(cache_path, key, size);
+        if(ret) return ret;
+      }
+#endif
       size_t loaded_size;
       auto ptr = it->second.Load(loaded_size, size, pad);
+#ifdef MMAP_AVAILABLE
+      if(!cache_path.empty()) saveCachedROM(cache_path, key, ptr.get(), size);
+#endif
       return std::make_unique<ARS::LoadedROMContent>(std::move(ptr), size);
     }
     std::unique_ptr<ARS::WritableMemory>
@@ -286,6 +419,7 @@ std::unique_ptr<ARS::GameFolder> ARS::openGameArchive(std::string path) {
       uint16_t method = get16(buf + 10);
       if(method != 0 && method != 8)
         throw sn.Get("GAME_ARCHIVE_ZIP_TOO_ADVANCED"_Key);
+      uint32_t crc32 = get32(buf + 16);
       uint16_t filename_length = get16(buf + 28);
       if(filename_length == 0)
         throw sn.Get("GAME_ARCHIVE_ZIP_CORRUPTED"_Key);
@@ -329,7 +463,7 @@ std::unique_ptr<ARS::GameFolder> ARS::openGameArchive(std::string path) {
            || std::equal(manifest_prefix.begin(), manifest_prefix.end(),
                          filename.begin()))
           files[filename] = ReadyToDecodeFile(in, file_offset,
-                                              path+':'+filename);
+                                              path+':'+filename, crc32);
       }
     }
     if(!found_manifest_prefix)
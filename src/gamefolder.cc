@@ -4,7 +4,34 @@
 #include "io.hh"
 #include <fstream>
 
+#ifdef MMAP_AVAILABLE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace {
+#ifdef MMAP_AVAILABLE
+  /* ROM that's a read-only view of the file itself. Loading it costs nothing
+     up front, pages are only read as the game touches them, and every
+     process that maps the same file shares one copy. (If the file is
+     truncated while it's mapped, we'll get SIGBUS; don't do that.) */
+  class MappedROMContent : public ARS::Memory {
+  public:
+    MappedROMContent(uint8_t* mapping, size_t size)
+      : Memory(mapping, size) {}
+    ~MappedROMContent() { munmap(memory_buffer, size); }
+  };
+  std::unique_ptr<ARS::Memory> mapROMContent(const std::string& path,
+                                             size_t size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return nullptr;
+    auto ret = ARS::mapROMContent(fd, size);
+    close(fd);
+    return ret;
+  }
+#endif
   class VolatileRAM : public ARS::WritableMemory {
   public:
     VolatileRAM(const uint8_t* init_p, size_t init_size,
@@ -118,13 +145,20 @@ namespace {
                                                size_t size,
                                                uint8_t pad) override {
       std::string contentpath = path + DIR_SEP + name;
-      std::unique_ptr<std::istream> f = IO::OpenRawPathForRead(contentpath);
-      if(!f || !*f) throw sn.Get("GAMEFOLDER_FILE_MISSING"_Key,
-                                 {contentpath});
-      std::unique_ptr<uint8_t[]> buf
-        = std::make_unique<uint8_t[]>(size);
-      size_t red = ARS::readFill(*f, contentpath, buf.get(), size);
-      if(red < size) memset(buf.get()+red, pad, size-red);
+      std::unique_ptr<ARS::Memory> ret;
+#ifdef MMAP_AVAILABLE
+      ret = mapROMContent(contentpath, size);
+#endif
+      if(!ret) {
+        std::unique_ptr<std::istream> f = IO::OpenRawPathForRead(contentpath);
+        if(!f || !*f) throw sn.Get("GAMEFOLDER_FILE_MISSING"_Key,
+                                   {contentpath});
+        std::unique_ptr<uint8_t[]> buf
+          = std::make_unique<uint8_t[]>(size);
+        size_t red = ARS::readFill(*f, contentpath, buf.get(), size);
+        if(red < size) memset(buf.get()+red, pad, size-red);
+        ret = std::make_unique<ARS::LoadedROMContent>(std::move(buf), size);
+      }
 #ifndef NO_DEBUG_CORES
       if(load_debug_symbols) {
         std::string sympath = contentpath + ".sym";
@@ -144,7 +178,7 @@ namespace {
         }
       }
 #endif
-      return std::make_unique<ARS::LoadedROMContent>(std::move(buf), size);
+      return ret;
     }
     std::unique_ptr<ARS::WritableMemory>
     getRAMContent(std::string name, size_t size, bool persistent,
@@ -309,6 +343,19 @@ size_t ARS::readFill(std::istream& in, const std::string& path,
   return size - rem;
 }
 
+#ifdef MMAP_AVAILABLE
+std::unique_ptr<ARS::Memory> ARS::mapROMContent(int fd, size_t size) {
+  struct stat st;
+  if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+     || st.st_size < static_cast<off_t>(size))
+    return nullptr;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(mapping == MAP_FAILED) return nullptr;
+  return std::make_unique<MappedROMContent>
+    (reinterpret_cast<uint8_t*>(mapping), size);
+}
+#endif
+
 std::vector<std::pair<std::string, uint8_t>>
 ARS::GameFolder::symbol_files_to_load;
 bool ARS::GameFolder::load_debug_symbols = false;
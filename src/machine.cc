@@ -0,0 +1,48 @@
+#include "machine.hh"
+#include "cpu.hh"
+#include "cartridge.hh"
+#include "expansions.hh"
+
+using namespace ARS;
+
+MainBoard::MainBoard() : dram() {}
+MainBoard::~MainBoard() {}
+
+Machine::Machine(bool primary) : board(), ppu(), apu() {
+  board.primary = primary;
+}
+
+Machine::~Machine() {
+  if(ARS::board == &board) {
+    ARS::board = nullptr;
+    PPU::state = nullptr;
+    apu_state = nullptr;
+  }
+}
+
+void Machine::makeCurrent() {
+  ARS::board = &board;
+  PPU::state = &ppu;
+  apu_state = &apu;
+}
+
+void Machine::powerOn(uint32_t seed) {
+  SDL_assert(ARS::board == &board);
+  board.garbage_source.seed(seed);
+  fillDramWithGarbage(board.dram, sizeof(board.dram));
+  PPU::fillWithGarbage();
+  apu.chip.resetstate(garbage);
+}
+
+void Machine::reset() {
+  SDL_assert(ARS::board == &board);
+  board.cartridge->handleReset();
+  PPU::handleReset();
+  board.cpu->setNMI(false);
+  board.cpu->setIRQ(false);
+  board.cpu->handleReset();
+  board.secure_config_port_checked = false;
+  for(auto& bank : board.bankMap)
+    bank = board.cartridge->getPowerOnBank();
+  rebuildPageTables();
+}
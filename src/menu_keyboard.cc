@@ -24,6 +24,11 @@ namespace {
     "EMULATOR_TOGGLE_SP"_Key,
     "EMULATOR_TOGGLE_OL"_Key,
     "EMULATOR_SCREENSHOT"_Key,
+    "EMULATOR_FREEZE"_Key,
+    "EMULATOR_DEFROST"_Key,
+    "EMULATOR_REWIND"_Key,
+    "EMULATOR_FAST_FORWARD"_Key,
+    "EMULATOR_AUDIO_STATS"_Key,
   };
   std::shared_ptr<Menu> createPlayerKeyboardMenu(size_t player) {
     std::vector<std::shared_ptr<Menu::Item> > items;
@@ -4,8 +4,9 @@
 #include "utfit.hh"
 #include <list>
 #include <algorithm>
+#include <mutex>
 
-ARS::MessageImp ARS::ui;
+thread_local ARS::MessageImp ARS::ui;
 
 namespace {
   constexpr int MESSAGES_CHARS_WIDE = 30;
@@ -31,6 +32,8 @@ namespace {
     LoggedMessage(std::string&& string, int lifespan)
       : string(string), lifespan(lifespan) {}
   };
+  // messages may come from any machine's thread
+  std::mutex messages_lock;
   std::list<LoggedMessage> logged_messages;
   bool messages_dirty = false;
   void draw_glyph(ARS::PPU::raw_screen& out,
@@ -61,6 +64,7 @@ namespace {
 }
 
 void ARS::PPU::cycleMessages() {
+  std::lock_guard<std::mutex> lock(messages_lock);
   while(!logged_messages.empty() && logged_messages.begin()->lifespan-- <=0){
     logged_messages.pop_front();
     messages_dirty = true;
@@ -68,6 +72,7 @@ void ARS::PPU::cycleMessages() {
 }
 
 void ARS::PPU::renderMessages(ARS::PPU::raw_screen& out) {
+  std::unique_lock<std::mutex> lock(messages_lock);
   int y = MESSAGES_HEIGHT + MESSAGES_MARGIN_Y;
   auto it = logged_messages.crbegin();
   while(it != logged_messages.crend() && y > MESSAGES_MARGIN_Y) {
@@ -88,6 +93,7 @@ void ARS::PPU::renderMessages(ARS::PPU::raw_screen& out) {
     }
     ++it;
   }
+  lock.unlock();
   cycleMessages();
 }
 
@@ -98,6 +104,7 @@ void ARS::MessageImp::outputLine(std::string line, int lifespan_value) {
 
 void ARS::MessageImp::outputBuffer() {
   std::string msg = stream.str();
+  std::lock_guard<std::mutex> lock(messages_lock);
   int lifespan = MESSAGE_LIFESPAN;
   for(auto& lmsg : logged_messages)
     lifespan -= lmsg.lifespan;
@@ -0,0 +1,196 @@
+#include "movie.hh"
+#include "io.hh"
+
+#include <iterator>
+
+using namespace ARS;
+
+namespace {
+  const char MAGIC[8] = {'A','R','S','M','O','V','I','E'};
+  // 2: the seed is for Machine::powerOn, instead of srand
+  constexpr uint8_t VERSION = 2;
+  constexpr size_t HEADER_SIZE = sizeof(MAGIC) + 1 + 4;
+  enum class State { IDLE, RECORDING, PLAYING, ENDED } state = State::IDLE;
+  std::string movie_path;
+  uint32_t seed;
+  // counts every frame, recording or playing, for messages
+  uint64_t frame_number;
+  bool desync_reported;
+  // recording
+  std::unique_ptr<std::ostream> out;
+  std::vector<uint8_t> this_frame, run_frame;
+  uint64_t run_length;
+  // playback
+  struct Run {
+    uint64_t length;
+    size_t offset, count; // into movie_data
+  };
+  std::vector<uint8_t> movie_data;
+  std::vector<Run> runs;
+  std::vector<Run>::iterator cur_run;
+  uint64_t run_frames_left;
+  size_t strobe_index;
+  void writeVarint(uint64_t value) {
+    while(value >= 0x80) {
+      out->put(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    out->put(static_cast<char>(value));
+  }
+  bool readVarint(size_t& pos, uint64_t& value) {
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+      if(pos >= movie_data.size()) return false;
+      uint8_t byte = movie_data[pos++];
+      value |= uint64_t(byte & 0x7F) << shift;
+      if(!(byte & 0x80)) return true;
+    }
+    return false;
+  }
+  void flushRun() {
+    if(run_length == 0) return;
+    writeVarint(run_length);
+    writeVarint(run_frame.size());
+    out->write(reinterpret_cast<const char*>(run_frame.data()),
+               run_frame.size());
+    run_length = 0;
+  }
+  void reportDesync() {
+    if(desync_reported) return;
+    desync_reported = true;
+    ui << sn.Get("MOVIE_DESYNC"_Key,
+                 {TEG::format("%llu", (unsigned long long)frame_number)})
+       << ui;
+  }
+}
+
+bool Movie::startRecording(const std::string& path, uint32_t new_seed) {
+  stop();
+  out = IO::OpenRawPathForWrite(path);
+  if(!out || !*out) {
+    sn.Out(std::cout, "MOVIE_FAILED_TO_OPEN"_Key, {path});
+    out.reset();
+    return false;
+  }
+  movie_path = path;
+  seed = new_seed;
+  uint8_t header[HEADER_SIZE];
+  memcpy(header, MAGIC, sizeof(MAGIC));
+  header[8] = VERSION;
+  for(int n = 0; n < 4; ++n) header[9+n] = seed >> (n * 8);
+  out->write(reinterpret_cast<const char*>(header), sizeof(header));
+  this_frame.clear();
+  run_frame.clear();
+  run_length = 0;
+  frame_number = 0;
+  state = State::RECORDING;
+  return true;
+}
+
+bool Movie::startPlayback(const std::string& path) {
+  stop();
+  auto in = IO::OpenRawPathForRead(path);
+  if(!in || !*in) {
+    sn.Out(std::cout, "MOVIE_FAILED_TO_OPEN"_Key, {path});
+    return false;
+  }
+  movie_data.assign(std::istreambuf_iterator<char>(*in),
+                    std::istreambuf_iterator<char>());
+  runs.clear();
+  bool valid = movie_data.size() >= HEADER_SIZE
+    && !memcmp(movie_data.data(), MAGIC, sizeof(MAGIC))
+    && movie_data[8] == VERSION;
+  size_t pos = HEADER_SIZE;
+  while(valid && pos < movie_data.size()) {
+    Run run;
+    uint64_t count;
+    if(!readVarint(pos, run.length) || run.length == 0
+       || !readVarint(pos, count) || count > movie_data.size() - pos) {
+      valid = false;
+      break;
+    }
+    run.offset = pos;
+    run.count = count;
+    pos += count;
+    runs.push_back(run);
+  }
+  if(!valid) {
+    sn.Out(std::cout, "MOVIE_INVALID"_Key, {path});
+    movie_data.clear();
+    runs.clear();
+    return false;
+  }
+  seed = 0;
+  for(int n = 0; n < 4; ++n) seed |= uint32_t(movie_data[9+n]) << (n * 8);
+  movie_path = path;
+  frame_number = 0;
+  desync_reported = false;
+  cur_run = runs.begin();
+  run_frames_left = cur_run == runs.end() ? 0 : cur_run->length;
+  strobe_index = 0;
+  state = cur_run == runs.end() ? State::ENDED : State::PLAYING;
+  return true;
+}
+
+uint32_t Movie::getSeed() { return seed; }
+bool Movie::isRecording() { return state == State::RECORDING; }
+bool Movie::isPlaying() { return state == State::PLAYING; }
+bool Movie::hasEnded() { return state == State::ENDED; }
+
+void Movie::recordStrobe(uint8_t value) {
+  this_frame.push_back(value);
+}
+
+uint8_t Movie::playStrobe() {
+  if(strobe_index >= cur_run->count) {
+    // the game is reading more often than it did when it was recorded
+    reportDesync();
+    return 0;
+  }
+  return movie_data[cur_run->offset + strobe_index++];
+}
+
+void Movie::endFrame() {
+  switch(state) {
+  case State::RECORDING:
+    if(run_length > 0 && this_frame == run_frame) ++run_length;
+    else {
+      flushRun();
+      run_frame.swap(this_frame);
+      run_length = 1;
+    }
+    this_frame.clear();
+    break;
+  case State::PLAYING:
+    if(strobe_index != cur_run->count) reportDesync();
+    strobe_index = 0;
+    if(--run_frames_left == 0) {
+      if(++cur_run == runs.end()) {
+        state = State::ENDED;
+        movie_data.clear();
+        runs.clear();
+        ui << sn.Get("MOVIE_PLAYBACK_FINISHED"_Key,
+                     {TEG::format("%llu",
+                                  (unsigned long long)frame_number + 1)})
+           << ui;
+      }
+      else run_frames_left = cur_run->length;
+    }
+    break;
+  default:
+    return;
+  }
+  ++frame_number;
+}
+
+void Movie::stop() {
+  if(state == State::RECORDING) {
+    flushRun();
+    out->flush();
+    if(!*out) sn.Out(std::cerr, "MOVIE_WRITE_FAILED"_Key, {movie_path});
+    out.reset();
+  }
+  movie_data.clear();
+  runs.clear();
+  state = State::IDLE;
+}
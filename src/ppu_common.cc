@@ -46,7 +46,7 @@ namespace {
         int pitch;
         SDL_LockTexture(debugtexture, nullptr,
                         reinterpret_cast<void**>(&pixels), &pitch);
-        const uint8_t* vramp = vram;
+        const uint8_t* vramp = state->vram;
         for(int x = 0; x < DEBUG_TILES_WIDE; ++x) {
           if(x % DEBUG_TILES_PER_DIVIDER == 0 && x != 0) {
             for(int y = 0; y < DEBUG_TILES_HIGH * 8; ++y) {
@@ -56,7 +56,8 @@ namespace {
           }
           for(int y = 0; y < DEBUG_TILES_HIGH; ++y) {
             for(int r = 0; r < 8; ++r) {
-              uint8_t inv = (vramp-vram) == vramAccessPtr ? 0xFF : 0x00;
+              uint8_t inv = (vramp-state->vram) == state->vramAccessPtr
+                ? 0xFF : 0x00;
               uint8_t plane = *vramp++;
               for(int bit = 0; bit < 8; ++bit) {
                 pixels[bit] = ((plane&(128>>bit))?0x1C:0x00)^inv;
@@ -75,96 +76,190 @@ namespace {
     }
   }
 #endif
-  int cur_scanline = LIVE_SCREEN_HEIGHT;
 }
 
 namespace ARS {
   namespace PPU {
-    bool show_overlay = true, show_sprites = true, show_background = true;
-    SpriteState ssm[NUM_SPRITES];
-    SpriteAttr sam[NUM_SPRITES];
-    uint8_t vram[0x10000];
-    uint8_t cram[0x100];
-    uint16_t vramAccessPtr;
-    uint8_t cramAccessPtr, ssmAccessPtr, samAccessPtr;
+    __thread State* state;
   }
 }
 
+const ARS::PPU::SpreadTable ARS::PPU::spread_bits;
+
+ARS::PPU::SpreadTable::SpreadTable() {
+  for(int n = 0; n < 256; ++n) {
+    uint8_t bytes[8];
+    for(int bit = 0; bit < 8; ++bit) bytes[bit] = (n >> (7-bit)) & 1;
+    memcpy(&entries[n], bytes, sizeof(bytes));
+  }
+}
+
+void ARS::PPU::TileCache::decodeGroup2(unsigned int group) {
+  const uint8_t* vram = state->vram;
+  uint16_t addr = group << 3;
+  for(int n = 0; n < 8; ++n, ++addr) {
+    state->tile_cache.rows2[addr] = spread_bits[vram[addr]]
+      | (spread_bits[vram[uint16_t(addr+8)]]<<1);
+  }
+  state->tile_cache.group_valid[group] |= ROWS2_VALID;
+}
+
+void ARS::PPU::TileCache::decodeGroup3(unsigned int group) {
+  const uint8_t* vram = state->vram;
+  uint16_t addr = group << 3;
+  for(int n = 0; n < 8; ++n, ++addr) {
+    state->tile_cache.rows3[addr] = spread_bits[vram[addr]]
+      | (spread_bits[vram[uint16_t(addr+8)]]<<1)
+      | (spread_bits[vram[uint16_t(addr+16)]]<<2);
+  }
+  state->tile_cache.group_valid[group] |= ROWS3_VALID;
+}
+
+void ARS::PPU::markVramDirty(uint16_t addr) {
+  uint8_t* group_valid = state->tile_cache.group_valid;
+  constexpr unsigned int GROUP_MASK
+    = sizeof(state->tile_cache.group_valid) - 1;
+  unsigned int group = addr >> 3;
+  // rows that start up to 16 bytes earlier have a plane here
+  group_valid[group] = 0;
+  group_valid[(group - 1) & GROUP_MASK] = 0;
+  group_valid[(group - 2) & GROUP_MASK] &= ~TileCache::ROWS3_VALID;
+}
+
+void ARS::PPU::markAllVramDirty() {
+  memset(state->tile_cache.group_valid, 0,
+         sizeof(state->tile_cache.group_valid));
+}
+
+void ARS::PPU::rebinSprite(int n) {
+  State& st = *state;
+  int top = st.ssm[n].Y;
+  int bottom = top + (((st.sam[n]>>SA_HEIGHT_SHIFT)&SA_HEIGHT_MASK)+1)*8;
+  if(bottom > LIVE_SCREEN_HEIGHT) bottom = LIVE_SCREEN_HEIGHT;
+  if(top > bottom) top = bottom;
+  if(top == st.binned_top[n] && bottom == st.binned_bottom[n]) return;
+  uint64_t bit = uint64_t(1) << n;
+  for(int y = st.binned_top[n]; y < st.binned_bottom[n]; ++y)
+    st.sprite_bins[y] &= ~bit;
+  for(int y = top; y < bottom; ++y)
+    st.sprite_bins[y] |= bit;
+  st.binned_top[n] = top;
+  st.binned_bottom[n] = bottom;
+}
+
+void ARS::PPU::rebinAllSprites() {
+  memset(state->sprite_bins, 0, sizeof(state->sprite_bins));
+  for(int n = 0; n < NUM_SPRITES; ++n) {
+    state->binned_top[n] = state->binned_bottom[n] = 0;
+    rebinSprite(n);
+  }
+}
+
+bool ARS::PPU::spriteBinIsCurrent(int scanline) {
+  const State& st = *state;
+  uint64_t expected = 0;
+  for(int n = 0; n < NUM_SPRITES; ++n) {
+    int top = st.ssm[n].Y;
+    int height = (((st.sam[n]>>SA_HEIGHT_SHIFT)&SA_HEIGHT_MASK)+1)*8;
+    if(scanline >= top && scanline < top + height)
+      expected |= uint64_t(1) << n;
+  }
+  return st.sprite_bins[scanline] == expected;
+}
+
 void ARS::PPU::updateScanline(int new_scanline) {
 #if !NO_DEBUG_CORES
   if(ARS::debugging_video)
     maybe_make_debug_window();
 #endif
-  cur_scanline = new_scanline;
-  ARS::cpu->setIRQ(cur_scanline >= ARS::Regs().irqScanline
-                   && (cur_scanline & 0x80)==(ARS::Regs().irqScanline&0x80));
+  state->cur_scanline = new_scanline;
+  ARS::board->cpu->setIRQ(new_scanline >= ARS::Regs().irqScanline
+                          && (new_scanline & 0x80)
+                          == (ARS::Regs().irqScanline&0x80));
 }
 
 void ARS::PPU::complexWrite(uint16_t addr, uint8_t value) {
   switch(addr) {
-  case 0x0210: vramAccessPtr = value<<8; break;
-  case 0x0211: vram[vramAccessPtr++] = value; break;
-  case 0x0212: cramAccessPtr = value; break;
-  case 0x0213: cram[cramAccessPtr++] = value; break;
-  case 0x0214: ssmAccessPtr = value; break;
-  case 0x0215: ssmBytes()[ssmAccessPtr++] = value; break;
-  case 0x0216: samAccessPtr = value; break;
-  case 0x0217: samBytes()[(samAccessPtr++)&63] = value; break;
-  case 0x0218: vramAccessPtr = (vramAccessPtr&0xFF00)|value; break;
-  case 0x0219: updateScanline(cur_scanline); break;
+  case 0x0210: state->vramAccessPtr = value<<8; break;
+  case 0x0211:
+    markVramDirty(state->vramAccessPtr);
+    state->vram[state->vramAccessPtr++] = value;
+    break;
+  case 0x0212: state->cramAccessPtr = value; break;
+  case 0x0213: state->cram[state->cramAccessPtr++] = value; break;
+  case 0x0214: state->ssmAccessPtr = value; break;
+  case 0x0215:
+    ssmBytes()[state->ssmAccessPtr] = value;
+    rebinSprite((state->ssmAccessPtr++) / sizeof(SpriteState));
+    break;
+  case 0x0216: state->samAccessPtr = value; break;
+  case 0x0217:
+    samBytes()[state->samAccessPtr&63] = value;
+    rebinSprite((state->samAccessPtr++)&63);
+    break;
+  case 0x0218:
+    state->vramAccessPtr = (state->vramAccessPtr&0xFF00)|value;
+    break;
+  case 0x0219: updateScanline(state->cur_scanline); break;
   case 0x021A: {
     uint16_t addr = value<<8;
     for(int n = 0; n < 256; ++n) {
-      vram[vramAccessPtr++] = ARS::read(addr++);
+      markVramDirty(state->vramAccessPtr);
+      state->vram[state->vramAccessPtr++] = ARS::read(addr++);
     }
-    ARS::cpu->eatCycles(257);
+    ARS::board->cpu->eatCycles(257);
   } break;
   case 0x021B: {
     uint16_t addr = value<<8;
     for(int y = 0; y < 16; ++y) {
       for(int x = 0; x < 16; ++x) {
-        vram[vramAccessPtr++] = ARS::read(addr+x);
-        vram[vramAccessPtr++] = ARS::read(addr+x);
+        state->vram[state->vramAccessPtr++] = ARS::read(addr+x);
+        state->vram[state->vramAccessPtr++] = ARS::read(addr+x);
       }
       for(int x = 0; x < 16; ++x) {
-        vram[vramAccessPtr++] = ARS::read(addr+x);
-        vram[vramAccessPtr++] = ARS::read(addr+x);
+        state->vram[state->vramAccessPtr++] = ARS::read(addr+x);
+        state->vram[state->vramAccessPtr++] = ARS::read(addr+x);
       }
       addr += 16;
+      for(int n = 1; n <= 64; ++n)
+        markVramDirty(state->vramAccessPtr - n);
     }
-    ARS::cpu->eatCycles(1025);
+    ARS::board->cpu->eatCycles(1025);
   } break;
   case 0x021C: {
     uint16_t addr = value<<8;
     for(int n = 0; n < 256; ++n) {
-      cram[cramAccessPtr++] = ARS::read(addr++);
+      state->cram[state->cramAccessPtr++] = ARS::read(addr++);
     }
-    ARS::cpu->eatCycles(257);
+    ARS::board->cpu->eatCycles(257);
   } break;
   case 0x021D: {
     uint16_t addr = value<<8;
     for(int n = 0; n < 256; ++n) {
-      ssmBytes()[ssmAccessPtr++] = ARS::read(addr++);
+      ssmBytes()[state->ssmAccessPtr++] = ARS::read(addr++);
     }
-    ARS::cpu->eatCycles(257);
+    rebinAllSprites();
+    ARS::board->cpu->eatCycles(257);
   } break;
   case 0x021E: {
     uint16_t addr = value<<8;
     for(int n = 0; n < 64; ++n) {
-      samBytes()[(samAccessPtr++)&63] = ARS::read(addr++);
+      samBytes()[(state->samAccessPtr++)&63] = ARS::read(addr++);
     }
-    ARS::cpu->eatCycles(65);
+    rebinAllSprites();
+    ARS::board->cpu->eatCycles(65);
   } break;
   case 0x021F: {
     uint16_t addr = value<<8;
     for(int n = 0; n < 64; ++n) {
-      ssmBytes()[ssmAccessPtr++] = ARS::read(addr);
-      ssmBytes()[ssmAccessPtr++] = ARS::read(addr+0x40);
-      ssmBytes()[ssmAccessPtr++] = ARS::read(addr+0x80);
-      ssmBytes()[ssmAccessPtr++] = ARS::read(addr+0xC0);
+      ssmBytes()[state->ssmAccessPtr++] = ARS::read(addr);
+      ssmBytes()[state->ssmAccessPtr++] = ARS::read(addr+0x40);
+      ssmBytes()[state->ssmAccessPtr++] = ARS::read(addr+0x80);
+      ssmBytes()[state->ssmAccessPtr++] = ARS::read(addr+0xC0);
       ++addr;
     }
-    ARS::cpu->eatCycles(257);
+    rebinAllSprites();
+    ARS::board->cpu->eatCycles(257);
   } break;
   default:
     // harmless
@@ -174,10 +269,10 @@ void ARS::PPU::complexWrite(uint16_t addr, uint8_t value) {
 
 uint8_t ARS::PPU::complexRead(uint16_t addr) {
   switch(addr) {
-  case 0x0211: return vram[vramAccessPtr];
-  case 0x0213: return cram[cramAccessPtr];
-  case 0x0215: return ssmBytes()[ssmAccessPtr];
-  case 0x0217: return samBytes()[samAccessPtr];
+  case 0x0211: return state->vram[state->vramAccessPtr];
+  case 0x0213: return state->cram[state->cramAccessPtr];
+  case 0x0215: return ssmBytes()[state->ssmAccessPtr];
+  case 0x0217: return samBytes()[state->samAccessPtr];
   default:
     SDL_assert("ARS::Regs::complexRead called with an inappropriate address"
                && false); // "interesting" idiom there...
@@ -186,23 +281,47 @@ uint8_t ARS::PPU::complexRead(uint16_t addr) {
 }
 
 
+namespace {
+  template<class Archive> void transfer_state(Archive& ar) {
+    State& st = *state;
+    ar(st.vram); ar(st.cram); ar(st.ssm); ar(st.sam);
+    ar(st.vramAccessPtr); ar(st.cramAccessPtr); ar(st.ssmAccessPtr);
+    ar(st.samAccessPtr);
+    ar(st.cur_scanline);
+  }
+}
+
+void ARS::PPU::freeze(Freezer& f) {
+  transfer_state(f);
+}
+
+void ARS::PPU::defrost(Defroster& d) {
+  transfer_state(d);
+  markAllVramDirty();
+  rebinAllSprites();
+}
+
 void ARS::PPU::fillWithGarbage() {
-  fillDramWithGarbage(vram, sizeof(vram));
-  fillDramWithGarbage(cram, sizeof(cram));
-  fillDramWithGarbage(ssmBytes(), sizeof(ssm));
-  fillDramWithGarbage(samBytes(), sizeof(sam));
+  fillDramWithGarbage(state->vram, sizeof(state->vram));
+  markAllVramDirty();
+  fillDramWithGarbage(state->cram, sizeof(state->cram));
+  fillDramWithGarbage(ssmBytes(), sizeof(state->ssm));
+  fillDramWithGarbage(samBytes(), sizeof(state->sam));
+  rebinAllSprites();
 }
 
 void ARS::PPU::handleReset() {
   ARS::Regs().multi1 = 0;
   ARS::Regs().irqScanline = 255;
-  cur_scanline = 255;
-  cpu->setIRQ(false);
+  state->cur_scanline = 255;
+  ARS::board->cpu->setIRQ(false);
 }
 
 void ARS::PPU::dumpSpriteMemory() {
   std::cerr << "Sprite memory:\n## ...SM... AM\n";
   std::cerr << std::hex;
+  const SpriteState* ssm = state->ssm;
+  const SpriteAttr* sam = state->sam;
   for(int n = 0; n < NUM_SPRITES; ++n) {
     std::cerr << std::setw(2) << std::setfill('0') << n << " " <<
       std::setw(2) << std::setfill('0') << (int)ssm[n].X <<
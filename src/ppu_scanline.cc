@@ -9,7 +9,6 @@
 using namespace ARS::PPU;
 
 namespace {
-  uint8_t spriteFetch[NUM_SPRITES*3];
   const uint8_t horizFlip[256] = {
     0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0,
     0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
@@ -51,6 +50,7 @@ namespace {
     int cur_screen;
     int bg_rowptr, bga_rowptr;
     int bg_ptr, bga_ptr;
+    uint16_t bg_row_addr;
     uint8_t bg_low_plane, bg_high_plane, bga_block;
     mode1_bg_engine(int scanline) {
       bg_y_tile = (ARS::Regs().bgScrollY + scanline) >> 3;
@@ -77,8 +77,9 @@ namespace {
       case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
       case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
       }
-      bg_low_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row];
-      bg_high_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row+8];
+      bg_row_addr = ((bgBase<<12)|(bg_tile<<4))+bg_y_row;
+      bg_low_plane = state->vram[bg_row_addr];
+      bg_high_plane = state->vram[bg_row_addr+8];
       bga_block = backgrounds_mode1()[cur_screen].Attributes[bga_ptr++];
     }
     void getState(uint8_t& bg_color, bool& bg_priority) {
@@ -97,32 +98,35 @@ namespace {
     }
     void advance() {
       ++bg_x_col;
-      if(bg_x_col == 8) {
-        bg_x_col = 0;
-        ++bg_x_tile;
-        if(bg_x_tile == MODE1_BACKGROUND_TILES_WIDE) {
-          cur_screen ^= 1;
-          bg_x_tile = 0;
-          bg_ptr = bg_rowptr;
-          bga_x_tile = 0;
-          bga_ptr = bga_rowptr;
-          bga_block = backgrounds_mode1()[cur_screen].Attributes[bga_ptr++];
-        }
-        else if((bg_x_tile&7)==0) {
-          bga_block = backgrounds_mode1()[cur_screen].Attributes[bga_ptr++];
-        }
-        uint8_t bg_tile = backgrounds_mode1()[cur_screen].Tiles[bg_ptr++];
-        uint8_t bgBase;
-        switch(cur_screen) {
-        default:
-        case 0: bgBase = ARS::Regs().bgTileBaseTop & 15; break;
-        case 1: bgBase = ARS::Regs().bgTileBaseTop >> 4; break;
-        case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
-        case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
-        }
-        bg_low_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row];
-        bg_high_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row+8];
+      if(bg_x_col == 8) nextTile();
+    }
+    // moves to the start of the next tile
+    void nextTile() {
+      bg_x_col = 0;
+      ++bg_x_tile;
+      if(bg_x_tile == MODE1_BACKGROUND_TILES_WIDE) {
+        cur_screen ^= 1;
+        bg_x_tile = 0;
+        bg_ptr = bg_rowptr;
+        bga_x_tile = 0;
+        bga_ptr = bga_rowptr;
+        bga_block = backgrounds_mode1()[cur_screen].Attributes[bga_ptr++];
+      }
+      else if((bg_x_tile&7)==0) {
+        bga_block = backgrounds_mode1()[cur_screen].Attributes[bga_ptr++];
       }
+      uint8_t bg_tile = backgrounds_mode1()[cur_screen].Tiles[bg_ptr++];
+      uint8_t bgBase;
+      switch(cur_screen) {
+      default:
+      case 0: bgBase = ARS::Regs().bgTileBaseTop & 15; break;
+      case 1: bgBase = ARS::Regs().bgTileBaseTop >> 4; break;
+      case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
+      case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
+      }
+      bg_row_addr = ((bgBase<<12)|(bg_tile<<4))+bg_y_row;
+      bg_low_plane = state->vram[bg_row_addr];
+      bg_high_plane = state->vram[bg_row_addr+8];
     }
   };
   struct mode2_bg_engine {
@@ -131,6 +135,7 @@ namespace {
     int cur_screen;
     int bg_rowptr, bg_ptr;
     uint8_t bg_pal;
+    uint16_t bg_row_addr;
     uint8_t bg_low_plane, bg_high_plane;
     mode2_bg_engine(int scanline) {
       bg_y_tile = (ARS::Regs().bgScrollY + scanline) >> 3;
@@ -157,8 +162,9 @@ namespace {
       case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
       case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
       }
-      bg_low_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row];
-      bg_high_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row+8];
+      bg_row_addr = ((bgBase<<12)|(bg_tile<<4))+bg_y_row;
+      bg_low_plane = state->vram[bg_row_addr];
+      bg_high_plane = state->vram[bg_row_addr+8];
     }
     void getState(uint8_t& bg_color, bool& bg_priority) {
       uint8_t raw_color = ((bg_low_plane>>(~bg_x_col&7))&1)
@@ -176,83 +182,119 @@ namespace {
     }
     void advance() {
       ++bg_x_col;
-      if(bg_x_col == 8) {
-        bg_x_col = 0;
-        ++bg_x_tile;
-        if(bg_x_tile == MODE2_BACKGROUND_TILES_WIDE) {
-          cur_screen ^= 1;
-          bg_x_tile = 0;
-          bg_ptr = bg_rowptr;
-        }
-        uint8_t bg_byte = backgrounds_mode2()[cur_screen].Tiles[bg_ptr++];
-        bg_pal = bg_byte&3;
-        uint8_t bg_tile = bg_byte&0xFC;
-        if(bg_x_tile&1) bg_tile |= 1;
-        if(bg_y_tile&1) bg_tile |= 2;
-        uint8_t bgBase;
-        switch(cur_screen) {
-        default:
-        case 0: bgBase = ARS::Regs().bgTileBaseTop & 15; break;
-        case 1: bgBase = ARS::Regs().bgTileBaseTop >> 4; break;
-        case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
-        case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
-        }
-        bg_low_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row];
-        bg_high_plane = vram[((bgBase<<12)|(bg_tile<<4))+bg_y_row+8];
+      if(bg_x_col == 8) nextTile();
+    }
+    // moves to the start of the next tile
+    void nextTile() {
+      bg_x_col = 0;
+      ++bg_x_tile;
+      if(bg_x_tile == MODE2_BACKGROUND_TILES_WIDE) {
+        cur_screen ^= 1;
+        bg_x_tile = 0;
+        bg_ptr = bg_rowptr;
       }
+      uint8_t bg_byte = backgrounds_mode2()[cur_screen].Tiles[bg_ptr++];
+      bg_pal = bg_byte&3;
+      uint8_t bg_tile = bg_byte&0xFC;
+      if(bg_x_tile&1) bg_tile |= 1;
+      if(bg_y_tile&1) bg_tile |= 2;
+      uint8_t bgBase;
+      switch(cur_screen) {
+      default:
+      case 0: bgBase = ARS::Regs().bgTileBaseTop & 15; break;
+      case 1: bgBase = ARS::Regs().bgTileBaseTop >> 4; break;
+      case 2: bgBase = ARS::Regs().bgTileBaseBot & 15; break;
+      case 3: bgBase = ARS::Regs().bgTileBaseBot >> 4; break;
+      }
+      bg_row_addr = ((bgBase<<12)|(bg_tile<<4))+bg_y_row;
+      bg_low_plane = state->vram[bg_row_addr];
+      bg_high_plane = state->vram[bg_row_addr+8];
     }
   };
 }
 
 namespace {
+  // address in VRAM of the first plane of sprite n's row on this scanline
+  uint16_t spriteRowAddress(int n, int scanline) {
+    const SpriteState& sprite = state->ssm[n];
+    int height = (((state->sam[n]>>SA_HEIGHT_SHIFT)&SA_HEIGHT_MASK)+1)*8;
+    int effective_y = scanline - sprite.Y;
+    if(sprite.TileAddr&SpriteState::VFLIP_MASK)
+      effective_y = height - effective_y - 1;
+    effective_y = (effective_y & 7) + (effective_y >> 3) * 24;
+    uint16_t tile_address =
+      (sprite.TileAddr & SpriteState::TILE_ADDR_MASK)
+      | (sprite.TilePage<<8);
+    return tile_address + effective_y;
+  }
+  /* "prefetch" all sprite tiles active on this scanline into spriteFetch
+     (three bytes each), flipped so that bit 0 is the leftmost pixel, and put
+     their indices into active_sprites. Returns the number of active
+     sprites. */
+  uint8_t prefetchSprites(int scanline, uint8_t* active_sprites,
+                          uint8_t* spriteFetch) {
+    const uint8_t* vram = state->vram;
+    const SpriteState* ssm = state->ssm;
+    uint8_t num_active_sprites = 0;
+    int spriteFetchIndex = 0;
+    SDL_assert(spriteBinIsCurrent(scanline));
+    // lowest numbered sprites first
+    for(uint64_t bin = state->sprite_bins[scanline]; bin != 0;
+        bin &= bin - 1) {
+      int n = __builtin_ctzll(bin);
+      active_sprites[num_active_sprites++] = n;
+      uint16_t row_address = spriteRowAddress(n, scanline);
+      if(ssm[n].TileAddr & SpriteState::HFLIP_MASK) {
+        spriteFetch[spriteFetchIndex++] = vram[row_address];
+        spriteFetch[spriteFetchIndex++] = vram[uint16_t(row_address+8)];
+        spriteFetch[spriteFetchIndex++] = vram[uint16_t(row_address+16)];
+      }
+      else {
+        spriteFetch[spriteFetchIndex++] = horizFlip[vram[row_address]];
+        spriteFetch[spriteFetchIndex++] =
+          horizFlip[vram[uint16_t(row_address+8)]];
+        spriteFetch[spriteFetchIndex++] =
+          horizFlip[vram[uint16_t(row_address+16)]];
+      }
+    }
+    return num_active_sprites;
+  }
+  // as prefetchSprites, but fetches decoded rows from the tile cache
+  uint8_t prefetchSpriteRows(int scanline, uint8_t* active_sprites,
+                             uint64_t* rows) {
+    uint8_t num_active_sprites = 0;
+    SDL_assert(spriteBinIsCurrent(scanline));
+    for(uint64_t bin = state->sprite_bins[scanline]; bin != 0;
+        bin &= bin - 1) {
+      int n = __builtin_ctzll(bin);
+      active_sprites[num_active_sprites] = n;
+      rows[num_active_sprites++]
+        = getDecodedRow3(spriteRowAddress(n, scanline),
+                         state->ssm[n].TileAddr & SpriteState::HFLIP_MASK);
+    }
+    return num_active_sprites;
+  }
   template<class BGEngine> void renderBits(raw_screen& out) {
+    auto& cpu = ARS::board->cpu;
+    const uint8_t* cram = state->cram;
+    const SpriteState* ssm = state->ssm;
+    const SpriteAttr* sam = state->sam;
     uint16_t overlay_ptr = 0, overlay_attr_ptr = 0;
     uint8_t active_sprites[NUM_SPRITES];
+    uint8_t spriteFetch[NUM_SPRITES*3];
     uint8_t num_active_sprites;
     for(int scanline = 0; scanline < LIVE_SCREEN_HEIGHT; ++scanline) {
       updateScanline(scanline);
-      ARS::cpu->runCycles(ARS::SAFE_BLANK_CYCLES_PER_SCANLINE);
+      cpu->runCycles(ARS::SAFE_BLANK_CYCLES_PER_SCANLINE);
       auto& out_row = out[scanline];
-      /* "prefetch" all sprite tiles */
-      num_active_sprites = 0;
-      int spriteFetchIndex = 0;
-      for(int n = 0; n < NUM_SPRITES; ++n) {
-        const SpriteState& sprite = ssm[n];
-        SpriteAttr attr = sam[n];
-        int height = (((attr>>SA_HEIGHT_SHIFT)&SA_HEIGHT_MASK)+1)*8;
-        if(sprite.Y > scanline || sprite.Y+height <= scanline) {
-          // sprite not active
-        }
-        else {
-          active_sprites[num_active_sprites++] = n;
-          int effective_y = scanline - sprite.Y;
-          if(sprite.TileAddr&SpriteState::VFLIP_MASK)
-            effective_y = height - effective_y - 1;
-          effective_y = (effective_y & 7) + (effective_y >> 3) * 24;
-          uint16_t tile_address =
-            (sprite.TileAddr & SpriteState::TILE_ADDR_MASK)
-            | (sprite.TilePage<<8);
-          if(sprite.TileAddr & SpriteState::HFLIP_MASK) {
-            spriteFetch[spriteFetchIndex++] = vram[tile_address+effective_y];
-            spriteFetch[spriteFetchIndex++] = vram[tile_address+effective_y+8];
-            spriteFetch[spriteFetchIndex++] =vram[tile_address+effective_y+16];
-          }
-          else {
-            spriteFetch[spriteFetchIndex++] =
-              horizFlip[vram[tile_address+effective_y]];
-            spriteFetch[spriteFetchIndex++] =
-              horizFlip[vram[tile_address+effective_y+8]];
-            spriteFetch[spriteFetchIndex++] =
-              horizFlip[vram[tile_address+effective_y+16]];
-          }
-        }
-      }
+      num_active_sprites = prefetchSprites(scanline, active_sprites,
+                                           spriteFetch);
       /* Initialize the background state machine */
       BGEngine bg_engine(scanline);
       /* Overlay state machine */
       uint8_t overlay_tile, overlay_attr = 0;
       uint8_t overlay_low_plane = 0, overlay_high_plane = 0;
-      ARS::cpu->runCycles(ARS::UNSAFE_BLANK_CYCLES_PER_SCANLINE);
+      cpu->runCycles(ARS::UNSAFE_BLANK_CYCLES_PER_SCANLINE);
       memset(out_row.data(), static_cast<uint8_t>(ARS::Regs().colorMod + 0xFF),
              LIVE_SCREEN_LEFT);
       /* Draw! */
@@ -273,7 +315,7 @@ namespace {
                                              &ARS::Regs::M1_OLBASE_MASK)<<12)
                                            +(overlay_tile << 4)
                                            +(scanline&7)+8, true);
-            ARS::cpu->eatCycles(3);
+            cpu->eatCycles(3);
           }
           if((column & 63) == 0) {
             overlay_attr = overlay().Attributes[overlay_attr_ptr++];
@@ -288,7 +330,7 @@ namespace {
           if((column & 63) == 0)
             ++overlay_attr_ptr;
         }
-        if(out_color != 0 && show_overlay) {
+        if(out_color != 0 && state->show_overlay) {
           /* Non-zero overlay pixels always take priority */
           out_color = static_cast<uint8_t>
             (cram[(((ARS::Regs().olBasePalette & 0x1F) << 3)
@@ -321,10 +363,10 @@ namespace {
             }
           }
           if(sprite_exists && (sprite_priority || !bg_priority)
-             && show_sprites) {
+             && state->show_sprites) {
             out_color = sprite_color;
           }
-          else if(show_background) {
+          else if(state->show_background) {
             out_color = static_cast<uint8_t>
               (cram[bg_color]+ARS::Regs().colorMod);
           }
@@ -333,7 +375,7 @@ namespace {
         out_row[column+LIVE_SCREEN_LEFT] = out_color;
         bg_engine.advance();
       }
-      ARS::cpu->runCycles(ARS::LIVE_CYCLES_PER_SCANLINE);
+      cpu->runCycles(ARS::LIVE_CYCLES_PER_SCANLINE);
       memset(out_row.data() + LIVE_SCREEN_RIGHT,
              static_cast<uint8_t>(ARS::Regs().colorMod + 0xFF),
              TOTAL_SCREEN_WIDTH - LIVE_SCREEN_RIGHT);
@@ -346,50 +388,205 @@ namespace {
   }
 }
 
+namespace {
+  /* Tile-at-a-time equivalent of renderBits. Produces identical output; run
+     with -P to get the original renderer and compare frame hashes (-X) if you
+     touch either one. */
+  // sprite_line entries: 0 = no sprite, otherwise these plus palette and color
+  constexpr uint8_t SPRITE_PRESENT = 0x40, SPRITE_FOREGROUND = 0x80;
+  constexpr uint8_t SPRITE_COLOR_MASK = 0x3F;
+  // the first (partially visible) background tile is decoded whole, starting
+  // up to 8 pixels left of the screen, and so can the last
+  constexpr int BG_LINE_SLOP = 8;
+  template<class BGEngine>
+  void decodeBackgroundLine(BGEngine& bg_engine, uint8_t* colors,
+                            uint8_t* priorities, uint8_t* screens) {
+    // the first tile was fetched before the last CPU cycles of hblank, which
+    // may have changed VRAM since; the rest are fetched as we go
+    uint64_t raw = spread_bits[bg_engine.bg_low_plane]
+      | (spread_bits[bg_engine.bg_high_plane]<<1);
+    for(int pos = BG_LINE_SLOP - bg_engine.bg_x_col;
+        pos < LIVE_SCREEN_WIDTH + BG_LINE_SLOP; pos += 8) {
+      uint8_t palette = bg_engine.getPalette();
+      uint8_t base = (ARS::Regs().bgBasePalette[bg_engine.cur_screen]<<4)
+        | (palette<<2);
+      uint64_t color = raw | (base * EVERY_BYTE);
+      uint64_t priority;
+      // same as getState's bg_num_background_colors logic
+      switch((ARS::Regs().bgForegroundInfo[bg_engine.cur_screen]
+              >>(palette<<1))&3) {
+      default:
+      case 0: priority = 0; break; // no foreground colors
+      case 1: priority = (raw >> 1) & EVERY_BYTE; break; // colors 2-3
+      case 2: priority = (raw | (raw >> 1)) & EVERY_BYTE; break; // colors 1-3
+      case 3: priority = EVERY_BYTE; break; // all colors
+      }
+      memcpy(colors + pos, &color, sizeof(color));
+      memcpy(priorities + pos, &priority, sizeof(priority));
+      memset(screens + pos, bg_engine.cur_screen, 8);
+      bg_engine.nextTile();
+      raw = getDecodedRow2(bg_engine.bg_row_addr);
+    }
+  }
+  template<class BGEngine> void renderTiles(raw_screen& out) {
+    auto& cpu = ARS::board->cpu;
+    const uint8_t* cram = state->cram;
+    const SpriteState* ssm = state->ssm;
+    const SpriteAttr* sam = state->sam;
+    uint16_t overlay_ptr = 0, overlay_attr_ptr = 0;
+    uint8_t active_sprites[NUM_SPRITES];
+    uint64_t sprite_rows[NUM_SPRITES];
+    uint8_t bg_colors[BG_LINE_SLOP + LIVE_SCREEN_WIDTH + 8];
+    uint8_t bg_priorities[BG_LINE_SLOP + LIVE_SCREEN_WIDTH + 8];
+    uint8_t bg_screens[BG_LINE_SLOP + LIVE_SCREEN_WIDTH + 8];
+    // a sprite at X=255 hangs 7 pixels off the right edge
+    uint8_t sprite_line[LIVE_SCREEN_WIDTH + 8];
+    // low two bits: color, bit 2: attribute bit
+    uint8_t overlay_line[LIVE_SCREEN_WIDTH];
+    for(int scanline = 0; scanline < LIVE_SCREEN_HEIGHT; ++scanline) {
+      updateScanline(scanline);
+      cpu->runCycles(ARS::SAFE_BLANK_CYCLES_PER_SCANLINE);
+      auto& out_row = out[scanline];
+      uint8_t num_active_sprites = prefetchSpriteRows(scanline, active_sprites,
+                                                      sprite_rows);
+      BGEngine bg_engine(scanline);
+      cpu->runCycles(ARS::UNSAFE_BLANK_CYCLES_PER_SCANLINE);
+      const uint8_t colorMod = ARS::Regs().colorMod;
+      memset(out_row.data(), static_cast<uint8_t>(colorMod + 0xFF),
+             LIVE_SCREEN_LEFT);
+      /* Overlay, one tile at a time */
+      uint8_t olBase = (ARS::Regs().multi1>>ARS::Regs::M1_OLBASE_SHIFT)
+        &ARS::Regs::M1_OLBASE_MASK;
+      if(olBase) {
+        uint8_t overlay_attr = 0;
+        for(int tile = 0; tile < OVERLAY_TILES_WIDE; ++tile) {
+          uint8_t overlay_tile = overlay().Tiles[overlay_ptr++];
+          uint8_t overlay_low_plane
+            = ARS::read((olBase<<12)+(overlay_tile<<4)+(scanline&7), true);
+          uint8_t overlay_high_plane
+            = ARS::read((olBase<<12)+(overlay_tile<<4)+(scanline&7)+8, true);
+          cpu->eatCycles(3);
+          if((tile & 7) == 0)
+            overlay_attr = overlay().Attributes[overlay_attr_ptr++];
+          uint8_t attr_bit = ((overlay_attr>>(~tile&7))&1)<<2;
+          uint64_t pixels = spread_bits[overlay_low_plane]
+            | (spread_bits[overlay_high_plane]<<1)
+            | (attr_bit * EVERY_BYTE);
+          memcpy(overlay_line + tile * 8, &pixels, sizeof(pixels));
+        }
+      }
+      else {
+        overlay_ptr += OVERLAY_TILES_WIDE;
+        overlay_attr_ptr += OVERLAY_TILES_WIDE/8;
+        memset(overlay_line, 0, sizeof(overlay_line));
+      }
+      /* Background, one tile at a time */
+      decodeBackgroundLine(bg_engine, bg_colors, bg_priorities, bg_screens);
+      /* Sprites, one sprite at a time; lower numbered sprites win */
+      memset(sprite_line, 0, sizeof(sprite_line));
+      if(state->show_sprites) {
+        for(uint8_t i = 0; i < num_active_sprites; ++i) {
+          auto& sprite = ssm[active_sprites[i]];
+          uint8_t tag = SPRITE_PRESENT
+            | (((sam[active_sprites[i]]>>SA_PALETTE_SHIFT)&SA_PALETTE_MASK)<<3);
+          if(sprite.TileAddr & SpriteState::FOREGROUND_MASK)
+            tag |= SPRITE_FOREGROUND;
+          uint8_t pixels[8];
+          memcpy(pixels, &sprite_rows[i], sizeof(pixels));
+          uint8_t* dst = sprite_line + sprite.X;
+          for(int n = 0; n < 8; ++n) {
+            if(pixels[n] != 0 && dst[n] == 0) dst[n] = tag | pixels[n];
+          }
+        }
+      }
+      /* Resolve palettes, one pass over the line */
+      uint8_t olPalette = (ARS::Regs().olBasePalette & 0x1F) << 3;
+      uint8_t spPalettes[4];
+      for(int n = 0; n < 4; ++n)
+        spPalettes[n] = ((ARS::Regs().spBasePalette>>(n<<1))&3)<<6;
+      for(int column = 0; column < LIVE_SCREEN_WIDTH; ++column) {
+        uint8_t out_color;
+        uint8_t ol = overlay_line[column];
+        uint8_t sp = sprite_line[column];
+        int bg = column + BG_LINE_SLOP;
+        if((ol & 3) != 0 && state->show_overlay)
+          out_color = static_cast<uint8_t>(cram[olPalette | ol] + colorMod);
+        else if(sp != 0 && ((sp & SPRITE_FOREGROUND) || !bg_priorities[bg]))
+          out_color = static_cast<uint8_t>
+            (cram[spPalettes[bg_screens[bg]] | (sp & SPRITE_COLOR_MASK)]
+             + colorMod);
+        else if(state->show_background)
+          out_color = static_cast<uint8_t>(cram[bg_colors[bg]] + colorMod);
+        else out_color = cram[colorMod];
+        out_row[column+LIVE_SCREEN_LEFT] = out_color;
+      }
+      cpu->runCycles(ARS::LIVE_CYCLES_PER_SCANLINE);
+      memset(out_row.data() + LIVE_SCREEN_RIGHT,
+             static_cast<uint8_t>(ARS::Regs().colorMod + 0xFF),
+             TOTAL_SCREEN_WIDTH - LIVE_SCREEN_RIGHT);
+      if((scanline&7) != 7 || (scanline < 8)
+         || (scanline > LIVE_SCREEN_HEIGHT-8)) {
+        overlay_ptr -= OVERLAY_TILES_WIDE;
+        overlay_attr_ptr -= OVERLAY_TILES_WIDE/8;
+      }
+    }
+  }
+}
+
+bool ARS::PPU::use_pixel_renderer = false;
+
 void ARS::PPU::renderFrame(raw_screen& out) {
+  auto& cpu = ARS::board->cpu;
   cpu->frameBoundary();
   cpu->runCycles(CYCLES_PER_VBLANK);
-  ARS::cpu->setNMI(false);
+  cpu->setNMI(false);
   if(!(ARS::Regs().multi1&ARS::Regs::M1_VIDEO_ENABLE_MASK)) {
-    ARS::cpu->runCycles((ARS::BLANK_CYCLES_PER_SCANLINE
+    cpu->runCycles((ARS::BLANK_CYCLES_PER_SCANLINE
                          + ARS::LIVE_CYCLES_PER_SCANLINE)
                         * LIVE_SCREEN_HEIGHT);
     memset(out.data(), static_cast<uint8_t>(ARS::Regs().colorMod + 0xFF),
            sizeof(out));
   }
   else {
-    if(ARS::Regs().multi1 & ARS::Regs::M1_BACKGROUND_MODE_MASK)
-      renderBits<mode2_bg_engine>(out);
-    else
-      renderBits<mode1_bg_engine>(out);
+    bool mode2 = ARS::Regs().multi1 & ARS::Regs::M1_BACKGROUND_MODE_MASK;
+    if(use_pixel_renderer) {
+      if(mode2) renderBits<mode2_bg_engine>(out);
+      else renderBits<mode1_bg_engine>(out);
+    }
+    else {
+      if(mode2) renderTiles<mode2_bg_engine>(out);
+      else renderTiles<mode1_bg_engine>(out);
+    }
     updateScanline(LIVE_SCREEN_HEIGHT);
   }
-  ARS::cpu->setNMI(true);
-  renderMessages(out);
+  cpu->setNMI(true);
+  // there's only one screen to put messages on
+  if(ARS::board->primary) renderMessages(out);
   tell_expansions_about_frame();
 }
 
 void ARS::PPU::renderInvisible() {
+  auto& cpu = ARS::board->cpu;
   cpu->frameBoundary();
   cpu->runCycles(CYCLES_PER_VBLANK);
-  ARS::cpu->setNMI(false);
+  cpu->setNMI(false);
   if(ARS::Regs().multi1&ARS::Regs::M1_VIDEO_ENABLE_MASK) {
     for(int scanline = 0; scanline < LIVE_SCREEN_HEIGHT; ++scanline) {
       updateScanline(scanline);
       if((ARS::Regs().multi1>>ARS::Regs::M1_OLBASE_SHIFT)
          &ARS::Regs::M1_OLBASE_MASK)
-        ARS::cpu->eatCycles(3*OVERLAY_TILES_WIDE);
-      ARS::cpu->runCycles(ARS::BLANK_CYCLES_PER_SCANLINE
+        cpu->eatCycles(3*OVERLAY_TILES_WIDE);
+      cpu->runCycles(ARS::BLANK_CYCLES_PER_SCANLINE
                           + ARS::LIVE_CYCLES_PER_SCANLINE);
     }
   }
   else {
-    ARS::cpu->runCycles((ARS::BLANK_CYCLES_PER_SCANLINE
+    cpu->runCycles((ARS::BLANK_CYCLES_PER_SCANLINE
                          + ARS::LIVE_CYCLES_PER_SCANLINE)
                         * LIVE_SCREEN_HEIGHT);
   }
   updateScanline(LIVE_SCREEN_HEIGHT);
-  ARS::cpu->setNMI(true);
-  cycleMessages();
+  cpu->setNMI(true);
+  if(ARS::board->primary) cycleMessages();
   tell_expansions_about_frame();
 }
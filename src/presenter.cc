@@ -0,0 +1,60 @@
+#include "presenter.hh"
+#include "fx.hh"
+
+using namespace ARS;
+
+Presenter::Presenter(size_t prepared_size, PrepareFunc prepare)
+  : prepare(prepare), wake(nullptr), thread(nullptr) {
+  for(int n = 0; n < 3; ++n) prepared[n].resize(prepared_size);
+  // If we weren't asked for more than one thread, or can't make one (e.g.
+  // in a browser without pthreads), submit prepares each frame itself.
+  if(FX::getThreadCount() <= 1) return;
+  wake = SDL_CreateSemaphore(0);
+  if(wake == nullptr) return;
+  thread = SDL_CreateThread(outer_body, "presenter", this);
+  if(thread == nullptr) {
+    SDL_DestroySemaphore(wake);
+    wake = nullptr;
+  }
+}
+
+Presenter::~Presenter() {
+  if(thread == nullptr) return;
+  quitting = true;
+  SDL_SemPost(wake);
+  SDL_WaitThread(thread, nullptr);
+  SDL_DestroySemaphore(wake);
+  // FX calls from this thread get the worker threads back
+  FX::adoptCurrentThread();
+}
+
+void Presenter::submit(const PPU::raw_screen& frame) {
+  if(thread == nullptr) {
+    prepare(frame, prepared.backBuffer().data());
+    prepared.publish();
+    return;
+  }
+  frames.backBuffer() = frame;
+  frames.publish();
+  SDL_SemPost(wake);
+}
+
+const uint8_t* Presenter::takePrepared() {
+  auto p = prepared.take();
+  return p ? p->data() : nullptr;
+}
+
+int Presenter::body() {
+  FX::adoptCurrentThread();
+  while(true) {
+    SDL_SemWait(wake);
+    if(quitting) break;
+    // several posts may have piled up while we were busy, the first one will
+    // get the newest frame and the rest will find nothing
+    auto frame = frames.take();
+    if(frame == nullptr) continue;
+    prepare(*frame, prepared.backBuffer().data());
+    prepared.publish();
+  }
+  return 0;
+}
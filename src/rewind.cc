@@ -0,0 +1,221 @@
+#include "rewind.hh"
+#include "savestate.hh"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+using namespace ARS;
+
+/*
+
+  History is a ring of records in a single preallocated arena. Every
+  KEYFRAME_INTERVAL frames, a full frozen state (a keyframe) is stored. Every
+  other frame is stored as a delta against the most recent keyframe: the XOR
+  of the two states, run-length encoded as a series of
+
+    uint16 skip: number of bytes that are identical to the keyframe
+    uint16 count: number of XORed bytes that follow
+    count bytes: keyframe ^ state
+
+  Deltas are against the keyframe rather than the previous frame, so restoring
+  any frame costs one keyframe copy plus one delta, no matter how far back it
+  is. A keyframe and the deltas that depend on it form a group, and are only
+  ever evicted together, oldest group first.
+
+ */
+
+namespace {
+  constexpr unsigned int FRAMES_PER_SECOND = 60;
+  constexpr unsigned int KEYFRAME_INTERVAL = 30;
+  constexpr size_t NO_SPACE = ~size_t(0);
+  struct Record {
+    size_t offset, length;
+    // offset of the keyframe this record depends on (its own, if it is one)
+    size_t key_offset;
+    unsigned int group_pos; // 0 = keyframe
+  };
+  unsigned int history_frames = 0;
+  std::unique_ptr<uint8_t[]> arena;
+  size_t arena_size = 0, state_size = 0;
+  std::vector<Record> records; // ring, preallocated
+  size_t first_record = 0, record_count = 0;
+  std::vector<uint8_t> cur_state, scratch;
+  Record& recordAt(size_t n) {
+    return records[(first_record + n) % records.size()];
+  }
+  Record& newestRecord() { return recordAt(record_count - 1); }
+  void evictOldestGroup() {
+    do {
+      first_record = (first_record + 1) % records.size();
+      --record_count;
+    } while(record_count > 0 && recordAt(0).group_pos != 0);
+  }
+  // Returns true if evicting the oldest group would also evict the group that
+  // the newest record belongs to.
+  bool oldestGroupIsNewest() {
+    for(size_t n = 1; n < record_count; ++n) {
+      if(recordAt(n).group_pos == 0) return false;
+    }
+    return true;
+  }
+  /* Finds room for `len` bytes in the arena, evicting old groups as needed. If
+     `protect_newest_group` is true, the newest group will not be evicted;
+     NO_SPACE is returned instead. */
+  size_t allocate(size_t len, bool protect_newest_group) {
+    if(len > arena_size) return NO_SPACE;
+    while(true) {
+      if(record_count == records.size()) {
+        if(protect_newest_group && oldestGroupIsNewest()) return NO_SPACE;
+        evictOldestGroup();
+        continue;
+      }
+      if(record_count == 0) return 0;
+      size_t head = recordAt(0).offset;
+      auto& newest = newestRecord();
+      size_t tail = newest.offset + newest.length;
+      if(tail > head) {
+        // not wrapped: free space is [tail, end) and [0, head)
+        if(arena_size - tail >= len) return tail;
+        if(head >= len) return 0;
+      }
+      else {
+        // wrapped: free space is [tail, head)
+        if(head - tail >= len) return tail;
+      }
+      if(protect_newest_group && oldestGroupIsNewest()) return NO_SPACE;
+      evictOldestGroup();
+    }
+  }
+  inline uint64_t load64(const uint8_t* p) {
+    uint64_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+  }
+  inline void put16(uint8_t*& p, size_t v) {
+    *p++ = v; *p++ = v >> 8;
+  }
+  inline size_t get16(const uint8_t*& p) {
+    size_t ret = p[0] | (p[1] << 8);
+    p += 2;
+    return ret;
+  }
+  /* Returns the length of the encoded delta, or 0 if it would be longer than
+     `out_size`. */
+  size_t encodeDelta(const uint8_t* key, const uint8_t* cur, size_t n,
+                     uint8_t* out, size_t out_size) {
+    uint8_t* o = out;
+    uint8_t* out_end = out + out_size;
+    size_t i = 0;
+    while(i < n) {
+      size_t skip_start = i;
+      size_t skip_limit = std::min(n, skip_start + 0xFFFF);
+      while(i + 8 <= skip_limit && load64(key+i) == load64(cur+i)) i += 8;
+      while(i < skip_limit && key[i] == cur[i]) ++i;
+      size_t lit_start = i;
+      size_t lit_limit = std::min(n, lit_start + 0xFFFF);
+      while(i < lit_limit && key[i] != cur[i]) ++i;
+      size_t count = i - lit_start;
+      if(out_end - o < static_cast<ptrdiff_t>(4 + count)) return 0;
+      put16(o, lit_start - skip_start);
+      put16(o, count);
+      for(size_t j = lit_start; j < i; ++j) *o++ = key[j] ^ cur[j];
+    }
+    return o - out;
+  }
+  void applyDelta(uint8_t* state, const uint8_t* delta, size_t len) {
+    const uint8_t* end = delta + len;
+    while(delta < end) {
+      state += get16(delta);
+      size_t count = get16(delta);
+      for(size_t j = 0; j < count; ++j) *state++ ^= *delta++;
+    }
+  }
+  void restore(const Record& record) {
+    if(record.group_pos == 0)
+      defrostMachine(arena.get() + record.offset, record.length);
+    else {
+      memcpy(scratch.data(), arena.get() + record.key_offset, state_size);
+      applyDelta(scratch.data(), arena.get() + record.offset, record.length);
+      defrostMachine(scratch.data(), state_size);
+    }
+  }
+}
+
+void Rewind::setHistoryLength(unsigned int seconds) {
+  history_frames = seconds * FRAMES_PER_SECOND;
+  clear();
+  arena.reset();
+  arena_size = 0;
+  state_size = 0;
+  records.clear();
+  records.shrink_to_fit();
+  if(history_frames > 0) records.resize(history_frames + 1);
+}
+
+void Rewind::clear() {
+  first_record = 0;
+  record_count = 0;
+}
+
+void Rewind::captureFrame() {
+  if(history_frames == 0) return;
+  freezeMachine(cur_state);
+  if(cur_state.size() != state_size) {
+    // first capture (or the state changed shape): size the arena so it can
+    // hold every keyframe in the history, plus as much again for deltas
+    state_size = cur_state.size();
+    size_t groups = (history_frames + KEYFRAME_INTERVAL - 1)
+      / KEYFRAME_INTERVAL + 1;
+    arena_size = groups * state_size * 2;
+    arena.reset(new uint8_t[arena_size]);
+    scratch.resize(state_size);
+    clear();
+  }
+  bool keyframe = record_count == 0
+    || newestRecord().group_pos + 1 >= KEYFRAME_INTERVAL;
+  size_t len = 0, offset = NO_SPACE;
+  if(!keyframe) {
+    len = encodeDelta(arena.get() + newestRecord().key_offset,
+                      cur_state.data(), state_size,
+                      scratch.data(), scratch.size());
+    if(len != 0) offset = allocate(len, true);
+    if(offset == NO_SPACE) keyframe = true;
+  }
+  if(keyframe) {
+    len = state_size;
+    offset = allocate(len, false);
+    if(offset == NO_SPACE) return;
+    memcpy(arena.get() + offset, cur_state.data(), len);
+  }
+  else
+    memcpy(arena.get() + offset, scratch.data(), len);
+  Record record;
+  record.offset = offset;
+  record.length = len;
+  if(keyframe) {
+    record.key_offset = offset;
+    record.group_pos = 0;
+  }
+  else {
+    record.key_offset = newestRecord().key_offset;
+    record.group_pos = newestRecord().group_pos + 1;
+  }
+  ++record_count;
+  newestRecord() = record;
+}
+
+bool Rewind::stepBack(unsigned int frames) {
+  // the newest record is the current state; we need something older
+  if(record_count < 2) return false;
+  if(frames > record_count - 1) frames = record_count - 1;
+  record_count -= frames;
+  try {
+    restore(newestRecord());
+  }
+  catch(std::string& reason) {
+    ui << reason << ui;
+    clear();
+  }
+  return true;
+}
@@ -0,0 +1,70 @@
+#include "savestate.hh"
+#include "cpu.hh"
+#include "ppu.hh"
+#include "apu.hh"
+#include "cartridge.hh"
+#include "expansions.hh"
+
+using namespace ARS;
+
+namespace {
+  const uint8_t FORMAT_MAGIC[4] = {'A','R','S','f'};
+  constexpr uint32_t FORMAT_VERSION = 2;
+  void freezeAll(Freezer& f, uint64_t layout_hash) {
+    f(FORMAT_MAGIC);
+    f(FORMAT_VERSION);
+    f(layout_hash);
+    freezeMainBoard(f);
+    PPU::freeze(f);
+    board->cpu->freeze(f);
+    apu_state->chip.transfer_state(f);
+    board->cartridge->freeze(f);
+    for(auto& expansion : board->expansions) {
+      f.layout(uint8_t(!!expansion));
+      if(expansion) expansion->freeze(f);
+    }
+  }
+  // everything after the header
+  void defrostParts(Defroster& d) {
+    defrostMainBoard(d);
+    PPU::defrost(d);
+    board->cpu->defrost(d);
+    apu_state->chip.transfer_state(d);
+    board->cartridge->defrost(d);
+    for(auto& expansion : board->expansions) {
+      d.layout(uint8_t(!!expansion));
+      if(expansion) expansion->defrost(d);
+    }
+    if(!d.atEnd()) throw sn.Get("DEFROST_WRONG_CARTRIDGE"_Key);
+  }
+}
+
+void ARS::freezeMachine(std::vector<uint8_t>& out) {
+  // (the hash isn't known until everything has been frozen)
+  Freezer f(out);
+  freezeAll(f, 0);
+  uint64_t layout_hash = f.getLayoutHash();
+  memcpy(out.data() + sizeof(FORMAT_MAGIC) + sizeof(FORMAT_VERSION),
+         &layout_hash, sizeof(layout_hash));
+}
+
+void ARS::defrostMachine(const uint8_t* blob, size_t len) {
+  Defroster d(blob, len);
+  uint8_t magic[4];
+  uint32_t version;
+  uint64_t layout_hash;
+  d(magic);
+  d(version);
+  if(memcmp(magic, FORMAT_MAGIC, sizeof(magic)) || version != FORMAT_VERSION)
+    throw sn.Get("DEFROST_BAD_STATE"_Key);
+  d(layout_hash);
+  // Measuring the machine copies nothing, but says how long a blob from
+  // this session is, and how it's laid out. One that doesn't match is
+  // turned away here, before any of the machine has been overwritten, and
+  // one that does can't fail partway through.
+  Freezer measure;
+  freezeAll(measure, 0);
+  if(len != measure.getLength() || layout_hash != measure.getLayoutHash())
+    throw sn.Get("DEFROST_WRONG_CARTRIDGE"_Key);
+  defrostParts(d);
+}
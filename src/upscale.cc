@@ -7,7 +7,7 @@ Upscaler::Upscaler(SignalType signal_type, UpscaleType upscale_type,
                    unsigned int& upscaled_width, unsigned int& upscaled_height,
                    unsigned int& output_left, unsigned int& output_top,
                    unsigned int& output_right, unsigned int& output_bottom)
-  : signal_type(signal_type), upscale_type(upscale_type), interbuf(nullptr) {
+  : signal_type(signal_type), upscale_type(upscale_type) {
   active_left = visible_left;
   active_top = visible_top;
   active_right = visible_right;
@@ -20,7 +20,6 @@ Upscaler::Upscaler(SignalType signal_type, UpscaleType upscale_type,
     if(active_right <= ARS::PPU::TOTAL_SCREEN_WIDTH-8) active_right += 8;
   }
   unsigned int active_width = active_right - active_left;
-  unsigned int active_height = active_bottom - active_top;
   unsigned int upscale_factor_x = 1, upscale_factor_y = 1;
   switch(signal_type) {
   default:
@@ -53,66 +52,40 @@ Upscaler::Upscaler(SignalType signal_type, UpscaleType upscale_type,
   output_top = (visible_top - active_top) * upscale_factor_y;
   output_right = (visible_right - active_left) * upscale_factor_x;
   output_bottom = (visible_bottom - active_top) * upscale_factor_y;
-  if(signal_type != SignalType::RGB) {
-    interbuf = reinterpret_cast<uint8_t*>
-      (safe_calloc(active_width,(active_height+(upscale_type>=UpscaleType::SCANLINES_CRISP?1:0))*sizeof(uint32_t)
-#ifndef SIMD_NOT_REAL
-                   +15
-#endif
-                   ));
-#ifndef SIMD_NOT_REAL
-    interstart = align_to(interbuf, 16);
-#endif
-  }
 }
 void Upscaler::apply(const ARS::PPU::raw_screen& in, void* out) {
-  if(signal_type == SignalType::RGB && upscale_type >= UpscaleType::SMOOTH)
-    FX::raw_screen_to_bgra_2x(in, interbuf == nullptr ? out : interbuf,
-                              active_left, active_top,
-                              active_right, active_bottom,
-                              upscale_type >= UpscaleType::SCANLINES_CRISP
-                              && signal_type == SignalType::RGB);
-  else
-    FX::raw_screen_to_bgra(in, interbuf == nullptr ? out : interbuf,
-                           active_left, active_top,
-                           active_right, active_bottom,
-                           upscale_type >= UpscaleType::SCANLINES_CRISP
-                           && signal_type == SignalType::RGB);
+  if(upscale_type >= UpscaleType::SCANLINES_CRISP) {
+    FX::Filter filter;
+    switch(signal_type) {
+    default:
+    case SignalType::RGB: filter = FX::Filter::RGB_2X; break;
+    case SignalType::SVIDEO: filter = FX::Filter::SVIDEO; break;
+    case SignalType::COMPOSITE: filter = FX::Filter::COMPOSITE; break;
+    }
+    FX::filter_with_scanlines(in, out, active_left, active_top,
+                              active_right, active_bottom, filter,
+                              upscale_type == UpscaleType::SCANLINES_BRIGHT);
+    return;
+  }
   switch(signal_type) {
   case SignalType::RGB:
+    if(upscale_type >= UpscaleType::SMOOTH)
+      FX::raw_screen_to_bgra_2x(in, out, active_left, active_top,
+                                active_right, active_bottom, false);
+    else
+      FX::raw_screen_to_bgra(in, out, active_left, active_top,
+                             active_right, active_bottom, false);
     break;
   case SignalType::SVIDEO:
-    FX::svideo_bgra(interbuf, out,
-                    active_right-active_left, active_bottom-active_top,
-                    upscale_type >= UpscaleType::SCANLINES_CRISP);
+    FX::svideo_raw_screen(in, out, active_left, active_top,
+                          active_right, active_bottom, false);
     break;
   case SignalType::COMPOSITE:
-    FX::composite_bgra(interbuf, out,
-                       active_right-active_left, active_bottom-active_top,
-                       upscale_type >= UpscaleType::SCANLINES_CRISP);
-    break;
-  }
-  switch(upscale_type) {
-  case UpscaleType::NONE:
-  case UpscaleType::SMOOTH:
-    break;
-  case UpscaleType::SCANLINES_CRISP:
-    FX::scanline_crisp_bgra(out, (active_right-active_left)*2,
-                            active_bottom-active_top);
-    break;
-  case UpscaleType::SCANLINES_BRIGHT:
-    FX::scanline_bright_bgra(out, (active_right-active_left)*2,
-                             active_bottom-active_top);
+    FX::composite_raw_screen(in, out, active_left, active_top,
+                             active_right, active_bottom, false);
     break;
   }
 }
-Upscaler::~Upscaler() {
-  if(interbuf != nullptr) {
-    safe_free(interbuf);
-    interbuf = nullptr;
-  }
-}
-
 const SN::ConstKey Upscaler::SIGNAL_TYPE_SELECTOR = "VIDEO_SIGNAL_TYPE"_Key;
 const std::array<SN::ConstKey, MAX_SIGNAL_TYPE+1> Upscaler::SIGNAL_TYPE_KEYS{{
   "VIDEO_SIGNAL_TYPE_COMPONENT"_Key,